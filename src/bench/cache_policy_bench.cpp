@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include <lru_cache.hpp>
+#include <cache_policy.hpp>
+
+namespace {
+
+constexpr size_t kCacheSize = 1024;
+constexpr size_t kHotKeyCount = 768;
+constexpr size_t kRoundCount = 200;
+constexpr size_t kHotLookupsPerRound = 8'000;
+constexpr size_t kScanLength = 4'000;
+
+// commuter-like traffic: skewed lookups of hot routes, every round is
+// followed by a burst of one-off routes that are never asked again
+std::vector<uint32_t> BuildTrace() {
+    std::mt19937 gen{42};
+    std::vector<double> weights(kHotKeyCount);
+    for (size_t index = 0; index < kHotKeyCount; ++index) {
+        weights[index] = 1.0 / (index + 1);
+    }
+    std::discrete_distribution<uint32_t> hot_keys{weights.begin(), weights.end()};
+
+    std::vector<uint32_t> trace;
+    trace.reserve(kRoundCount * (kHotLookupsPerRound + kScanLength));
+
+    uint32_t one_off_key = kHotKeyCount;
+    for (size_t round = 0; round < kRoundCount; ++round) {
+        for (size_t index = 0; index < kHotLookupsPerRound; ++index) {
+            trace.push_back(hot_keys(gen));
+        }
+        for (size_t index = 0; index < kScanLength; ++index) {
+            trace.push_back(one_off_key++);
+        }
+    }
+
+    return trace;
+}
+
+template<typename PolicyType>
+void RunBench(std::string_view name, const std::vector<uint32_t>& trace) {
+    waybuilder::__detail::LruCache<uint32_t, uint64_t, kCacheSize,
+        waybuilder::__detail::UnitWeigher<uint64_t>, PolicyType> cache;
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t key : trace) {
+        if (!cache.get_handle(key)) {
+            cache.insert(key, key);
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    const auto& stats = cache.stats();
+
+    std::cout << std::left << std::setw(12) << name
+        << std::right << std::fixed << std::setprecision(2)
+        << std::setw(10) << 100.0 * stats.hits / (stats.hits + stats.misses) << " % hits"
+        << std::setw(12) << stats.evictions << " evictions"
+        << std::setprecision(1)
+        << std::setw(10) << std::chrono::duration<double, std::nano>(elapsed).count() / trace.size() << " ns/op"
+        << std::endl;
+}
+
+} // namespace
+
+int main(int, char**) {
+    auto trace = BuildTrace();
+
+    std::cout << "cache size: " << kCacheSize << " | hot keys: " << kHotKeyCount
+        << " | scan length: " << kScanLength << " | operations: " << trace.size() << std::endl;
+
+    RunBench<waybuilder::__detail::LruPolicy<uint32_t>>("LRU", trace);
+    RunBench<waybuilder::__detail::WTinyLfuPolicy<uint32_t>>("W-TinyLFU", trace);
+    RunBench<waybuilder::__detail::ArcPolicy<uint32_t>>("ARC", trace);
+
+    return 0;
+}
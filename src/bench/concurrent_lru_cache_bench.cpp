@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <lru_cache.hpp>
+#include <concurrent_lru_cache.hpp>
+
+namespace {
+
+constexpr size_t kCacheSize = 4096;
+constexpr size_t kKeySpace = 4 * kCacheSize;
+constexpr size_t kOperationPerThread = 1'000'000;
+
+struct WayValue {
+    std::time_t stamp;
+    uint64_t payload[6];
+};
+
+// baseline: the plain LruCache behind one global mutex
+template<typename KeyType, typename ValueType, size_t CacheSize>
+class GlobalLockLruCache {
+ public:
+    bool insert(const KeyType& key, const ValueType& value) {
+        std::lock_guard lock{mutex_};
+        return cache_.insert(key, value);
+    };
+
+    std::optional<ValueType> get(const KeyType& key) {
+        std::lock_guard lock{mutex_};
+        return cache_.get(key);
+    };
+
+ private:
+    std::mutex mutex_;
+    waybuilder::__detail::LruCache<KeyType, ValueType, CacheSize> cache_;
+};
+
+std::vector<std::string> BuildKeys() {
+    std::vector<std::string> keys;
+    keys.reserve(kKeySpace);
+
+    for (size_t index = 0; index < kKeySpace; ++index) {
+        keys.push_back("c" + std::to_string(index % 97) + "s" + std::to_string(index));
+    }
+
+    return keys;
+}
+
+std::vector<uint32_t> BuildTrace(uint32_t seed) {
+    std::mt19937 gen{seed};
+    std::discrete_distribution<uint32_t> hot_dist{{3, 1}};
+    std::uniform_int_distribution<uint32_t> hot_keys{0, kCacheSize - 1};
+    std::uniform_int_distribution<uint32_t> cold_keys{0, kKeySpace - 1};
+
+    std::vector<uint32_t> trace(kOperationPerThread);
+    for (auto& key_index : trace) {
+        key_index = hot_dist(gen) == 0 ? hot_keys(gen) : cold_keys(gen);
+    }
+
+    return trace;
+}
+
+template<typename CacheType>
+double RunBench(size_t thread_count, const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint32_t>>& traces) {
+    CacheType cache;
+
+    for (size_t index = 0; index < kKeySpace; ++index) {
+        cache.insert(keys[index], WayValue{});
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t thread_index = 0; thread_index < thread_count; ++thread_index) {
+        workers.emplace_back([&cache, &keys, &trace = traces[thread_index]]() {
+            WayValue value{};
+            for (uint32_t key_index : trace) {
+                if (!cache.get(keys[key_index])) {
+                    value.stamp = key_index;
+                    cache.insert(keys[key_index], value);
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return thread_count * kOperationPerThread / elapsed / 1e6;
+}
+
+} // namespace
+
+int main(int, char**) {
+    using GlobalLockCache = GlobalLockLruCache<std::string, WayValue, kCacheSize>;
+    using ShardedCache = waybuilder::__detail::ConcurrentLruCache<std::string, WayValue, kCacheSize>;
+
+    const size_t max_thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 2;
+
+    auto keys = BuildKeys();
+    std::vector<std::vector<uint32_t>> traces;
+    for (size_t thread_index = 0; thread_index < max_thread_count; ++thread_index) {
+        traces.push_back(BuildTrace(42 + thread_index));
+    }
+
+    std::cout << "cache size: " << kCacheSize << " | shards: " << ShardedCache::shard_count()
+        << " | operations per thread: " << kOperationPerThread << "\n"
+        << std::setw(8) << "threads" << std::setw(20) << "global mutex Mop/s" << std::setw(20) << "sharded Mop/s" << std::endl;
+
+    for (size_t thread_count = 1; thread_count <= max_thread_count; thread_count *= 2) {
+        std::cout << std::setw(8) << thread_count << std::fixed << std::setprecision(2)
+            << std::setw(20) << RunBench<GlobalLockCache>(thread_count, keys, traces)
+            << std::setw(20) << RunBench<ShardedCache>(thread_count, keys, traces) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lru_cache.hpp>
+#include <flat_lru_cache.hpp>
+
+namespace {
+
+size_t allocation_count = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr size_t kCacheSize = 1024;
+constexpr size_t kKeySpace = 4 * kCacheSize;
+constexpr size_t kOperationCount = 4'000'000;
+
+struct WayValue {
+    std::time_t stamp;
+    uint64_t payload[6];
+};
+
+std::vector<std::string> BuildKeys() {
+    std::vector<std::string> keys;
+    keys.reserve(kKeySpace);
+
+    for (size_t index = 0; index < kKeySpace; ++index) {
+        keys.push_back("c" + std::to_string(index % 97) + "s" + std::to_string(index));
+    }
+
+    return keys;
+}
+
+std::vector<uint32_t> BuildTrace() {
+    std::mt19937 gen{42};
+    // skewed access: most probes land on a hot quarter of the key space
+    std::discrete_distribution<uint32_t> hot_dist{{3, 1}};
+    std::uniform_int_distribution<uint32_t> hot_keys{0, kCacheSize - 1};
+    std::uniform_int_distribution<uint32_t> cold_keys{0, kKeySpace - 1};
+
+    std::vector<uint32_t> trace(kOperationCount);
+    for (auto& key_index : trace) {
+        key_index = hot_dist(gen) == 0 ? hot_keys(gen) : cold_keys(gen);
+    }
+
+    return trace;
+}
+
+template<typename CacheType>
+void RunBench(std::string_view name, const std::vector<std::string>& keys, const std::vector<uint32_t>& trace) {
+    CacheType cache;
+    WayValue value{};
+
+    // warm up to steady state, cache is full after this loop
+    for (size_t index = 0; index < kKeySpace; ++index) {
+        cache.insert(keys[index], value);
+    }
+
+    size_t hit_count = 0;
+    size_t start_allocation_count = allocation_count;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t key_index : trace) {
+        const std::string& key = keys[key_index];
+        if (auto cached = cache.get(key); cached) {
+            hit_count += cached->stamp + 1;
+        } else {
+            value.stamp = key_index;
+            cache.insert(key, value);
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    size_t allocations = allocation_count - start_allocation_count;
+
+    std::cout << std::left << std::setw(16) << name
+        << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+        << std::chrono::duration<double, std::nano>(elapsed).count() / trace.size() << " ns/op"
+        << std::setw(14) << allocations << " allocs"
+        << std::setw(14) << hit_count << " checksum" << std::endl;
+}
+
+} // namespace
+
+int main(int, char**) {
+    auto keys = BuildKeys();
+    auto trace = BuildTrace();
+
+    std::cout << "cache size: " << kCacheSize << " | key space: " << kKeySpace
+        << " | operations: " << kOperationCount << std::endl;
+
+    RunBench<waybuilder::__detail::LruCache<std::string, WayValue, kCacheSize>>("LruCache", keys, trace);
+    RunBench<waybuilder::__detail::FlatLruCache<std::string, WayValue, kCacheSize>>("FlatLruCache", keys, trace);
+
+    return 0;
+}
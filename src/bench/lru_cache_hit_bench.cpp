@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include <lru_cache.hpp>
+
+namespace {
+
+constexpr size_t kCacheSize = 16;
+constexpr size_t kHitCount = 2'000;
+
+// ways-like response: a "segments" array of thread objects
+nlohmann::json BuildResponse(size_t segment_count) {
+    nlohmann::json response;
+    response["search"] = {{"from", {{"code", "c213"}}}, {"to", {{"code", "c2"}}}, {"date", "2024-01-01"}};
+
+    auto& segments = response["segments"] = nlohmann::json::array();
+    for (size_t index = 0; index < segment_count; ++index) {
+        segments.push_back({
+            {"departure", "2024-01-01T10:00:00+03:00"},
+            {"arrival", "2024-01-01T14:00:00+03:00"},
+            {"duration", 14400},
+            {"thread", {{"number", "SU " + std::to_string(index)}, {"title", "Moscow - Saint Petersburg"}}}
+        });
+    }
+
+    return response;
+}
+
+template<typename HitFuncType>
+double MeasureHits(HitFuncType&& hit) {
+    size_t checksum = 0;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t index = 0; index < kHitCount; ++index) {
+        checksum += hit();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    if (checksum == 0) {
+        std::cerr << "no hits" << std::endl;
+    }
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / kHitCount;
+}
+
+} // namespace
+
+int main(int, char**) {
+    std::cout << std::left << std::setw(14) << "response"
+        << std::right << std::setw(16) << "get() copy" << std::setw(18) << "get_handle()" << std::endl;
+
+    for (size_t segment_count : {4, 32, 256, 1024}) {
+        waybuilder::__detail::LruCache<int, nlohmann::json, kCacheSize> cache;
+
+        nlohmann::json response = BuildResponse(segment_count);
+        const size_t response_size = response.dump().size();
+        cache.insert(0, std::move(response));
+
+        double copy_ns = MeasureHits([&cache]() { return cache.get(0)->size(); });
+        double handle_ns = MeasureHits([&cache]() { return cache.get_handle(0)->size(); });
+
+        std::cout << std::left << std::setw(14) << (std::to_string(response_size) + " B")
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(13) << copy_ns << " ns" << std::setw(15) << handle_ns << " ns" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,507 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <ya_rasp_transport.hpp>
+
+// Local stand-in of the yandex rasp api for load tests: serves the search and
+// stations_list endpoints over plain http with keep-alive. Bodies come from
+// a recorded corpus when one is given, synthetic data is made otherwise.
+// Each response waits for a sampled latency, a share of them fails with
+// 429 or 5xx, another share drops the connection without an answer.
+//
+// rasp_stand_in [--port 8080] [--threads 4] [--stations 10000] [--corpus dir]
+//     [--latency fixed|exponential|lognormal] [--latency-ms 50] [--sigma 0.5]
+//     [--error-rate 0] [--drop-rate 0]
+
+namespace {
+
+using boost::asio::ip::tcp;
+
+enum class LatencyDistribution { FIXED, EXPONENTIAL, LOGNORMAL };
+
+struct StandInConfig {
+    unsigned short port = 8080;
+    size_t thread_count = 4;
+    size_t station_count = 10000;
+    std::string corpus_path;
+
+    LatencyDistribution latency = LatencyDistribution::FIXED;
+    // mean of fixed and exponential latency, median of lognormal one
+    double latency_ms = 50;
+    double sigma = 0.5;
+
+    double error_rate = 0;
+    double drop_rate = 0;
+};
+
+struct Reply {
+    int status_code = 200;
+    std::shared_ptr<const std::string> body;
+    bool is_dropped = false;
+};
+
+constexpr size_t kStationsInCity = 4;
+constexpr size_t kCitiesInRegion = 10;
+constexpr size_t kRegionsInCountry = 10;
+constexpr size_t kDefaultPageSize = 100;
+constexpr size_t kDaysMaskSize = 60;
+
+std::mt19937_64& Random() {
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    return random;
+}
+
+
+uint64_t Hash(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (unsigned char text_char : text) {
+        hash ^= text_char;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+
+std::unordered_map<std::string, std::string> ParseQuery(std::string_view query) {
+    std::unordered_map<std::string, std::string> args;
+
+    while (!query.empty()) {
+        size_t arg_end = query.find('&');
+        std::string_view arg = query.substr(0, arg_end);
+        query.remove_prefix(arg_end == std::string_view::npos ? query.size() : arg_end + 1);
+
+        size_t value_pos = arg.find('=');
+        if (value_pos != std::string_view::npos) {
+            args.emplace(arg.substr(0, value_pos), arg.substr(value_pos + 1));
+        }
+    }
+
+    return args;
+}
+
+
+std::chrono::sys_days Today() {
+    return std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+}
+
+
+std::optional<std::chrono::sys_days> ParseDate(const std::string& date) {
+    int year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+
+    if (std::sscanf(date.c_str(), "%d-%u-%u", &year, &month, &day) != 3) {
+        return {};
+    }
+
+    std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{month}, std::chrono::day{day}};
+    return ymd.ok() ? std::optional{std::chrono::sys_days{ymd}} : std::nullopt;
+}
+
+
+std::string FormatDate(std::chrono::sys_days days) {
+    std::chrono::year_month_day ymd{days};
+    char date[16];
+    std::snprintf(date, sizeof(date), "%04d-%02u-%02u",
+        static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+    return date;
+}
+
+
+std::string FormatTime(int64_t minutes) {
+    char time[16];
+    std::snprintf(time, sizeof(time), "%02d:%02d:00", static_cast<int>(minutes / 60 % 24), static_cast<int>(minutes % 60));
+    return time;
+}
+
+
+nlohmann::json MakePoint(std::string_view code, std::string_view type) {
+    return {{"code", code}, {"title", "Station " + std::string{code}}, {"popular_title", "Station " + std::string{code}},
+        {"station_type", type}, {"type", "station"}};
+}
+
+
+// segments of a search are a function of the pair, dated searches of a day
+nlohmann::json SearchJson(const std::unordered_map<std::string, std::string>& args) {
+    auto arg = [&args](const std::string& name) { auto arg_it = args.find(name); return arg_it == args.end() ? std::string{} : arg_it->second; };
+
+    const std::string from_point = arg("from");
+    const std::string to_point = arg("to");
+    const std::string date = arg("date");
+    const bool add_days_mask = arg("add_days_mask") == "true";
+
+    const size_t offset = arg("offset").empty() ? 0 : std::stoul(arg("offset"));
+    const size_t limit = arg("limit").empty() ? kDefaultPageSize : std::stoul(arg("limit"));
+
+    const uint64_t pair_seed = Hash(from_point + '|' + to_point);
+    const uint64_t seed = Hash(from_point + '|' + to_point + '|' + date);
+    const size_t total = 10 + seed % 190;
+
+    const auto day = date.empty() ? Today() : ParseDate(date).value_or(Today());
+
+    nlohmann::json ways_json;
+    ways_json["search"] = {{"from", MakePoint(from_point, "train_station")}, {"to", MakePoint(to_point, "train_station")}};
+    if (!date.empty()) {
+        ways_json["search"]["date"] = date;
+    }
+    ways_json["interval_segments"] = nlohmann::json::array();
+    nlohmann::json& segments = ways_json["segments"] = nlohmann::json::array();
+
+    for (size_t segment_index = offset; segment_index < std::min(total, offset + limit); ++segment_index) {
+        const uint64_t thread_seed = pair_seed + segment_index * 2654435761ull;
+        const int64_t departure_minutes = thread_seed % (24 * 60);
+        const int64_t duration_minutes = 30 + thread_seed / 7 % (12 * 60);
+        const int64_t arrival_minutes = departure_minutes + duration_minutes;
+
+        nlohmann::json segment;
+        segment["thread"] = {{"title", "Route " + std::to_string(thread_seed % 10000)}, {"number", std::to_string(thread_seed % 1000)},
+            {"transport_type", thread_seed % 2 ? "train" : "suburban"}, {"vehicle", nullptr}};
+        segment["from"] = MakePoint(from_point, "train_station");
+        segment["to"] = MakePoint(to_point, "train_station");
+        segment["duration"] = duration_minutes * 60;
+        segment["has_transfers"] = false;
+        segment["start_date"] = FormatDate(day);
+
+        if (add_days_mask && date.empty()) {
+            // weekly pattern of the thread over the next days
+            std::string days_mask;
+            for (size_t mask_index = 0; mask_index < kDaysMaskSize; ++mask_index) {
+                days_mask += (thread_seed >> (mask_index % 7)) & 1 ? '1' : '0';
+            }
+            segment["days_mask"] = days_mask;
+            segment["departure"] = FormatTime(departure_minutes);
+            segment["arrival"] = FormatTime(arrival_minutes);
+        } else {
+            segment["departure"] = FormatDate(day) + 'T' + FormatTime(departure_minutes) + "+03:00";
+            segment["arrival"] = FormatDate(day + std::chrono::days{arrival_minutes / (24 * 60)}) + 'T' + FormatTime(arrival_minutes) + "+03:00";
+        }
+
+        segments.push_back(std::move(segment));
+    }
+
+    ways_json["pagination"] = {{"total", total}, {"limit", limit}, {"offset", offset}};
+    return ways_json;
+}
+
+
+nlohmann::json StationsListJson(size_t station_count) {
+    nlohmann::json countries = nlohmann::json::array();
+    const size_t stations_in_country = kStationsInCity * kCitiesInRegion * kRegionsInCountry;
+
+    for (size_t station_index = 0; station_index < station_count; ++station_index) {
+        const size_t country_index = station_index / stations_in_country;
+        const size_t region_index = station_index / (kStationsInCity * kCitiesInRegion);
+        const size_t city_index = station_index / kStationsInCity;
+
+        if (countries.size() == country_index) {
+            countries.push_back({{"title", "Country " + std::to_string(country_index)},
+                {"codes", {{"yandex_code", "l" + std::to_string(country_index)}}}, {"regions", nlohmann::json::array()}});
+        }
+
+        nlohmann::json& regions = countries.back()["regions"];
+        if (region_index % kRegionsInCountry == regions.size()) {
+            regions.push_back({{"title", "Region " + std::to_string(region_index)},
+                {"codes", {{"yandex_code", "r" + std::to_string(region_index)}}}, {"settlements", nlohmann::json::array()}});
+        }
+
+        nlohmann::json& cities = regions.back()["settlements"];
+        if (city_index % kCitiesInRegion == cities.size()) {
+            cities.push_back({{"title", "City " + std::to_string(city_index)},
+                {"codes", {{"yandex_code", "c" + std::to_string(city_index)}}}, {"stations", nlohmann::json::array()}});
+        }
+
+        cities.back()["stations"].push_back({{"title", "Station s" + std::to_string(station_index)},
+            {"codes", {{"yandex_code", "s" + std::to_string(station_index)}}},
+            {"station_type", "train_station"}, {"transport_type", "train"}});
+    }
+
+    return {{"countries", std::move(countries)}};
+}
+
+
+class Responder {
+ public:
+    explicit Responder(const StandInConfig& config) : config_{config},
+        stations_body_{std::make_shared<const std::string>(StationsListJson(config.station_count).dump())} {
+        if (!config_.corpus_path.empty()) {
+            corpus_.emplace(config_.corpus_path);
+        }
+    };
+
+ public:
+    Reply Respond(std::string_view target) const {
+        std::uniform_real_distribution<double> share{0.0, 1.0};
+
+        if (share(Random()) < config_.drop_rate) {
+            return Reply{0, nullptr, true};
+        }
+
+        if (share(Random()) < config_.error_rate) {
+            static constexpr int kErrorCodes[] = {429, 500, 502, 503};
+            const int status_code = kErrorCodes[Random()() % std::size(kErrorCodes)];
+            return Reply{status_code, std::make_shared<const std::string>(R"({"error":{"text":"stand-in failure"}})")};
+        }
+
+        if (auto recorded = Recorded(target); recorded) {
+            return *recorded;
+        }
+
+        const size_t query_pos = target.find('?');
+        const std::string_view path = target.substr(0, query_pos);
+        const auto args = ParseQuery(query_pos == std::string_view::npos ? std::string_view{} : target.substr(query_pos + 1));
+
+        if (path.ends_with("/search/")) {
+            return Reply{200, std::make_shared<const std::string>(SearchJson(args).dump())};
+        } else if (path.ends_with("/stations_list/")) {
+            return Reply{200, stations_body_};
+        }
+
+        return Reply{404, std::make_shared<const std::string>(R"({"error":{"text":"unknown endpoint"}})")};
+    };
+
+    std::chrono::microseconds SampleLatency() const {
+        double latency_ms = config_.latency_ms;
+
+        if (config_.latency == LatencyDistribution::EXPONENTIAL) {
+            latency_ms = std::exponential_distribution<double>{1.0 / config_.latency_ms}(Random());
+        } else if (config_.latency == LatencyDistribution::LOGNORMAL) {
+            latency_ms = std::lognormal_distribution<double>{std::log(config_.latency_ms), config_.sigma}(Random());
+        }
+
+        return std::chrono::microseconds{static_cast<int64_t>(latency_ms * 1000)};
+    };
+
+ private:
+    std::optional<Reply> Recorded(std::string_view target) const {
+        if (!corpus_) {
+            return {};
+        }
+
+        const std::string key = waybuilder::YaRaspCorpus::MakeKey(target);
+        const auto record = corpus_->Load(key);
+
+        if (!record) {
+            return {};
+        }
+
+        std::ifstream body_file{corpus_->GetBodyPath(key), std::ios::binary};
+        return Reply{static_cast<int>(record->status_code), std::make_shared<const std::string>(
+            std::istreambuf_iterator<char>{body_file}, std::istreambuf_iterator<char>{})};
+    };
+
+ private:
+    const StandInConfig& config_;
+    std::shared_ptr<const std::string> stations_body_;
+    // corpus lookups only read files
+    mutable std::optional<waybuilder::YaRaspCorpus> corpus_;
+};
+
+
+std::string_view StatusText(int status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+
+// one keep-alive connection, requests are answered in order
+class Connection : public std::enable_shared_from_this<Connection> {
+ public:
+    Connection(tcp::socket socket, const Responder& responder)
+        : socket_{std::move(socket)}, timer_{socket_.get_executor()}, responder_{responder} {  };
+
+ public:
+    void Read() {
+        boost::asio::async_read_until(socket_, request_buffer_, "\r\n\r\n",
+            [self = shared_from_this()](boost::system::error_code ec, size_t header_size) {
+                if (!ec) {
+                    self->Handle(header_size);
+                }
+            });
+    };
+
+ private:
+    void Handle(size_t header_size) {
+        std::string header(boost::asio::buffers_begin(request_buffer_.data()),
+            boost::asio::buffers_begin(request_buffer_.data()) + header_size);
+        request_buffer_.consume(header_size);
+
+        // "GET target HTTP/1.1"
+        const size_t target_pos = header.find(' ');
+        const size_t version_pos = header.find(' ', target_pos + 1);
+
+        if (target_pos == std::string::npos || version_pos == std::string::npos) {
+            return;
+        }
+
+        keep_alive_ = header.find("Connection: close") == std::string::npos;
+        reply_ = responder_.Respond(std::string_view{header}.substr(target_pos + 1, version_pos - target_pos - 1));
+
+        timer_.expires_after(responder_.SampleLatency());
+        timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+            if (!ec) {
+                self->Write();
+            }
+        });
+    };
+
+    void Write() {
+        if (reply_.is_dropped) {
+            boost::system::error_code ec;
+            socket_.close(ec);
+            return;
+        }
+
+        reply_header_ = "HTTP/1.1 " + std::to_string(reply_.status_code) + ' ' + std::string{StatusText(reply_.status_code)} + "\r\n"
+            + "Content-Type: application/json; charset=utf-8\r\n"
+            + "Content-Length: " + std::to_string(reply_.body->size()) + "\r\n"
+            + (keep_alive_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n")
+            + "\r\n";
+
+        std::vector<boost::asio::const_buffer> buffers{boost::asio::buffer(reply_header_), boost::asio::buffer(*reply_.body)};
+
+        boost::asio::async_write(socket_, buffers, [self = shared_from_this()](boost::system::error_code ec, size_t) {
+            if (!ec && self->keep_alive_) {
+                self->Read();
+            }
+        });
+    };
+
+ private:
+    tcp::socket socket_;
+    boost::asio::steady_timer timer_;
+    boost::asio::streambuf request_buffer_;
+    const Responder& responder_;
+
+    Reply reply_;
+    std::string reply_header_;
+    bool keep_alive_ = true;
+};
+
+
+class StandInServer {
+ public:
+    StandInServer(boost::asio::io_context& io_context, const StandInConfig& config, const Responder& responder)
+        : io_context_{io_context}, acceptor_{io_context, tcp::endpoint{tcp::v4(), config.port}}, responder_{responder} {  };
+
+ public:
+    void Accept() {
+        // each connection runs on its own strand
+        acceptor_.async_accept(boost::asio::make_strand(io_context_), [this](boost::system::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<Connection>(std::move(socket), responder_)->Read();
+            }
+            Accept();
+        });
+    };
+
+ private:
+    boost::asio::io_context& io_context_;
+    tcp::acceptor acceptor_;
+    const Responder& responder_;
+};
+
+
+bool ParseArgs(int argc, char** argv, StandInConfig& config) {
+    for (int arg_index = 1; arg_index + 1 < argc; arg_index += 2) {
+        const std::string_view name = argv[arg_index];
+        const std::string value = argv[arg_index + 1];
+
+        if (name == "--port") {
+            config.port = static_cast<unsigned short>(std::stoul(value));
+        } else if (name == "--threads") {
+            config.thread_count = std::max<size_t>(std::stoul(value), 1);
+        } else if (name == "--stations") {
+            config.station_count = std::stoul(value);
+        } else if (name == "--corpus") {
+            config.corpus_path = value;
+        } else if (name == "--latency" && value == "fixed") {
+            config.latency = LatencyDistribution::FIXED;
+        } else if (name == "--latency" && value == "exponential") {
+            config.latency = LatencyDistribution::EXPONENTIAL;
+        } else if (name == "--latency" && value == "lognormal") {
+            config.latency = LatencyDistribution::LOGNORMAL;
+        } else if (name == "--latency-ms") {
+            config.latency_ms = std::stod(value);
+        } else if (name == "--sigma") {
+            config.sigma = std::stod(value);
+        } else if (name == "--error-rate") {
+            config.error_rate = std::stod(value);
+        } else if (name == "--drop-rate") {
+            config.drop_rate = std::stod(value);
+        } else {
+            std::cerr << "unknown argument: " << name << " " << value << std::endl;
+            return false;
+        }
+    }
+
+    return argc % 2 == 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    StandInConfig config;
+
+    try {
+        if (!ParseArgs(argc, argv, config)) {
+            std::cerr << "usage: rasp_stand_in [--port 8080] [--threads 4] [--stations 10000] [--corpus dir]" << "\n"
+                << "    [--latency fixed|exponential|lognormal] [--latency-ms 50] [--sigma 0.5]" << "\n"
+                << "    [--error-rate 0] [--drop-rate 0]" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "bad argument value: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    const Responder responder{config};
+
+    boost::asio::io_context io_context{static_cast<int>(config.thread_count)};
+    StandInServer server{io_context, config, responder};
+    server.Accept();
+
+    std::cout << "api stand-in: http://localhost:" << config.port << "/v3.0/" << "\n"
+        << "stations: " << config.station_count << ", threads: " << config.thread_count << std::endl;
+
+    std::vector<std::thread> threads;
+    for (size_t thread_index = 1; thread_index < config.thread_count; ++thread_index) {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+    io_context.run();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return 0;
+}
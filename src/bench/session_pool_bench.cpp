@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <cpr/cpr.h>
+
+#include <ya_rasp_session_pool.hpp>
+
+namespace {
+
+constexpr size_t kRequestCount = 200;
+
+// local https stand-in of the api, self-signed certificates are not verified
+const std::string kDefaultUrl = "https://localhost:8443/v3.0/search/";
+
+template<typename GetFuncType>
+double MeasureRequests(GetFuncType&& get) {
+    size_t error_count = 0;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t index = 0; index < kRequestCount; ++index) {
+        if (get().status_code != 200) {
+            ++error_count;
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    if (error_count) {
+        std::cerr << error_count << " failed requests" << std::endl;
+    }
+
+    return std::chrono::duration<double, std::milli>(elapsed).count() / kRequestCount;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string url = argc > 1 ? argv[1] : kDefaultUrl;
+
+    waybuilder::YaRaspSessionPool pool;
+    pool.Configure(waybuilder::YaRaspSessionPool::kDefaultTimeout, waybuilder::YaRaspSessionPool::kDefaultConnectTimeout, false);
+
+    double get_ms = MeasureRequests([&url]() {
+        return cpr::Get(cpr::Url{url}, cpr::VerifySsl{false});
+    });
+    double pool_ms = MeasureRequests([&url, &pool]() { return pool.Get(url); });
+
+    std::cout << "url: " << url << "\n"
+        << std::fixed << std::setprecision(3)
+        << std::left << std::setw(20) << "cpr::Get" << std::right << std::setw(10) << get_ms << " ms/request" << "\n"
+        << std::left << std::setw(20) << "session pool" << std::right << std::setw(10) << pool_ms << " ms/request" << "\n"
+        << "sessions created: " << pool.GetCreatedCount() << std::endl;
+
+    return 0;
+}
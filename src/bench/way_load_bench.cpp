@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <console_cli_app.hpp>
+#include <app_commands.hpp>
+#include <output_manager.hpp>
+#include <ya_rasp_cli.hpp>
+
+// Open loop load of way lookups against the api stand-in (rasp_stand_in):
+// queries arrive at a fixed rate whatever the latency is, a late query keeps
+// its scheduled start, so queueing behind slow ones counts in its latency.
+// Routes follow a zipf mix, dates are spread over the next days. Each worker
+// runs the list way command with a cache of its own, as an operator would.
+//
+// way_load_bench [--url http://localhost:8080] [--qps 50] [--duration 30]
+//     [--workers 8] [--routes 1000] [--days 3] [--stations 10000]
+
+namespace {
+
+using ClockType = std::chrono::steady_clock;
+using CacheType = waybuilder::ConsoleWayBuilderApp::CacheType;
+
+struct LoadConfig {
+    std::string url = "http://localhost:8080";
+    double qps = 50;
+    size_t duration_s = 30;
+    size_t worker_count = 8;
+    size_t route_count = 1000;
+    size_t day_count = 3;
+    size_t station_count = 10000;
+};
+
+struct Query {
+    std::string from_point;
+    std::string to_point;
+    std::string date;
+};
+
+// skewed routes, the first ones are asked most
+class QueryMix {
+ public:
+    QueryMix(const LoadConfig& config) : config_{config}, route_weights_{MakeWeights(config.route_count)},
+        random_{std::random_device{}()} {  };
+
+ public:
+    Query Next() {
+        std::lock_guard lock{mutex_};
+
+        // stations of a route are spread over the stations list
+        const uint64_t route_index = route_weights_(random_);
+        const uint64_t station_count = std::max<uint64_t>(config_.station_count, 2);
+        const uint64_t from_index = route_index * 7919 % station_count;
+        const uint64_t to_index = (from_index + 1 + route_index % (station_count - 1)) % station_count;
+
+        std::uniform_int_distribution<size_t> day_distribution{0, std::max<size_t>(config_.day_count, 1) - 1};
+        const auto date = std::chrono::system_clock::now() + std::chrono::days(day_distribution(random_));
+
+        return Query{"s" + std::to_string(from_index), "s" + std::to_string(to_index), waybuilder::commands::FormatDate(date)};
+    };
+
+ private:
+    static std::discrete_distribution<uint64_t> MakeWeights(size_t route_count) {
+        std::vector<double> weights(std::max<size_t>(route_count, 1));
+        for (size_t index = 0; index < weights.size(); ++index) {
+            weights[index] = 1.0 / (index + 1);
+        }
+        return {weights.begin(), weights.end()};
+    };
+
+ private:
+    const LoadConfig& config_;
+    std::mutex mutex_;
+    std::discrete_distribution<uint64_t> route_weights_;
+    std::mt19937_64 random_;
+};
+
+
+bool ParseArgs(int argc, char** argv, LoadConfig& config) {
+    for (int arg_index = 1; arg_index + 1 < argc; arg_index += 2) {
+        const std::string_view name = argv[arg_index];
+        const std::string value = argv[arg_index + 1];
+
+        if (name == "--url") {
+            config.url = value;
+        } else if (name == "--qps") {
+            config.qps = std::max(std::stod(value), 0.1);
+        } else if (name == "--duration") {
+            config.duration_s = std::stoul(value);
+        } else if (name == "--workers") {
+            config.worker_count = std::max<size_t>(std::stoul(value), 1);
+        } else if (name == "--routes") {
+            config.route_count = std::stoul(value);
+        } else if (name == "--days") {
+            config.day_count = std::stoul(value);
+        } else if (name == "--stations") {
+            config.station_count = std::stoul(value);
+        } else {
+            std::cerr << "unknown argument: " << name << " " << value << std::endl;
+            return false;
+        }
+    }
+
+    return argc % 2 == 1;
+}
+
+
+// api config pointing at the stand-in, quota and pacing never hold back the load
+std::filesystem::path WriteApiCfg(const LoadConfig& config, const std::filesystem::path& work_path) {
+    nlohmann::json api_cfg_json;
+    api_cfg_json["api_key"] = "stand-in";
+    api_cfg_json["api_url"] = config.url;
+    api_cfg_json["api_version"] = "v3.0";
+    api_cfg_json["api_lang"] = "ru_RU";
+    api_cfg_json["point_list_path"] = (work_path / "point_list.json").string();
+    api_cfg_json["daily_request_limit"] = 1'000'000'000u;
+    api_cfg_json["request_rate"] = 1'000'000.0;
+    api_cfg_json["request_burst"] = 1'000'000u;
+    api_cfg_json["max_connections"] = config.worker_count;
+
+    const auto api_cfg_path = work_path / "api_cfg.json";
+    std::ofstream{api_cfg_path} << api_cfg_json.dump(4);
+    return api_cfg_path;
+}
+
+
+double Percentile(const std::vector<double>& sorted_latencies, double share) {
+    if (sorted_latencies.empty()) {
+        return 0;
+    }
+
+    const size_t index = static_cast<size_t>(share * (sorted_latencies.size() - 1));
+    return sorted_latencies[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+
+    try {
+        if (!ParseArgs(argc, argv, config)) {
+            std::cerr << "usage: way_load_bench [--url http://localhost:8080] [--qps 50] [--duration 30]" << "\n"
+                << "    [--workers 8] [--routes 1000] [--days 3] [--stations 10000]" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "bad argument value: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    const auto work_path = std::filesystem::temp_directory_path() / ("way_load_bench_" + std::to_string(std::random_device{}()));
+    std::filesystem::create_directories(work_path);
+
+    waybuilder::YaRaspCli cli{WriteApiCfg(config, work_path).string(), (work_path / "logs/").string()};
+    QueryMix query_mix{config};
+
+    const size_t query_count = static_cast<size_t>(config.qps * config.duration_s);
+    std::atomic<size_t> next_query{0};
+
+    std::mutex result_mutex;
+    std::vector<double> latencies_ms;
+    latencies_ms.reserve(query_count);
+
+    const auto start_time = ClockType::now();
+
+    std::vector<std::thread> workers;
+    for (size_t worker_index = 0; worker_index < config.worker_count; ++worker_index) {
+        workers.emplace_back([&, worker_index]() {
+            std::ostream null_stream{nullptr};
+            waybuilder::YaRaspOutputManager output_manager{null_stream};
+
+            CacheType cache{(work_path / ("cache_" + std::to_string(worker_index) + "/")).string(),
+                waybuilder::ConsoleWayBuilderApp::kWayCacheLifetime, cli.GetCacheGrace(), cli.GetPrefetchBudget(), cli.GetCacheBudget()};
+
+            std::vector<double> worker_latencies_ms;
+
+            for (size_t query_index = next_query++; query_index < query_count; query_index = next_query++) {
+                const auto scheduled_time = start_time + std::chrono::duration_cast<ClockType::duration>(
+                    std::chrono::duration<double>(query_index / config.qps));
+                std::this_thread::sleep_until(scheduled_time);
+
+                const Query query = query_mix.Next();
+                waybuilder::commands::ListWay<CacheType>{cli, output_manager, cache, query.from_point, query.to_point, query.date}.Run();
+
+                worker_latencies_ms.push_back(std::chrono::duration<double, std::milli>(ClockType::now() - scheduled_time).count());
+            }
+
+            std::lock_guard lock{result_mutex};
+            latencies_ms.insert(latencies_ms.end(), worker_latencies_ms.begin(), worker_latencies_ms.end());
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const double elapsed_s = std::chrono::duration<double>(ClockType::now() - start_time).count();
+    std::sort(latencies_ms.begin(), latencies_ms.end());
+
+    const auto search_stats = cli.GetSearchGuardRef().GetStats();
+
+    std::cout << "url: " << config.url << ", target qps: " << config.qps << ", workers: " << config.worker_count << "\n"
+        << std::fixed << std::setprecision(2)
+        << std::left << std::setw(20) << "queries" << std::right << std::setw(12) << latencies_ms.size() << "\n"
+        << std::left << std::setw(20) << "throughput" << std::right << std::setw(12) << latencies_ms.size() / elapsed_s << " q/s" << "\n"
+        << std::left << std::setw(20) << "p50 latency" << std::right << std::setw(12) << Percentile(latencies_ms, 0.50) << " ms" << "\n"
+        << std::left << std::setw(20) << "p99 latency" << std::right << std::setw(12) << Percentile(latencies_ms, 0.99) << " ms" << "\n"
+        << std::left << std::setw(20) << "max latency" << std::right << std::setw(12) << Percentile(latencies_ms, 1.0) << " ms" << "\n"
+        << std::left << std::setw(20) << "api requests" << std::right << std::setw(12) << cli.GetSchedulerRef().GetUsed() << "\n"
+        << std::left << std::setw(20) << "retries" << std::right << std::setw(12) << search_stats.retries << "\n"
+        << std::left << std::setw(20) << "hedges won" << std::right << std::setw(12) << search_stats.hedge_wins
+            << " of " << search_stats.hedges << "\n"
+        << std::left << std::setw(20) << "fast failures" << std::right << std::setw(12) << search_stats.fast_failures << std::endl;
+
+    std::error_code ec;
+    std::filesystem::remove_all(work_path, ec);
+
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <utility>
 
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/trivial.hpp>
@@ -47,11 +48,41 @@ R"help(
 * find station [find_substring]
     - get list of avalible stations by similar request
 
+* cache usage
+    - memory used by cached ways and configured budget
+* cache stats
+    - hit, miss, eviction and expiration counters of the ways cache
+      hits of failed searches answered locally, ways refreshed or prefetched
+      in background, speculative prefetches of predicted queries and their hits,
+      dated searches answered by schedule templates, coalesced searches
+
+* quota
+    - api requests used today, remaining daily budget and refused requests,
+      retried and hedged requests, requests failed fast and the api circuit state
+
 * logdir
     - path to directory to log journal
 )help";
 
 
+CommandExeStatus Quota::Run() {
+    const auto& scheduler = cli_.GetSchedulerRef();
+    const auto search_stats = cli_.GetSearchGuardRef().GetStats();
+    const auto points_stats = cli_.GetPointsGuardRef().GetStats();
+
+    output_manager_.GetStreamRef()
+        << "requests today: " << scheduler.GetUsed() << " / " << scheduler.GetDailyLimit() << "\n"
+        << "remaining budget: " << scheduler.GetRemaining() << "\n"
+        << "refused requests: " << scheduler.GetRefusedCount() << "\n"
+        << "retried requests: " << search_stats.retries + points_stats.retries << "\n"
+        << "hedged requests: " << search_stats.hedges << " (won " << search_stats.hedge_wins << ")" << "\n"
+        << "failed fast: " << search_stats.fast_failures + points_stats.fast_failures << "\n"
+        << "api circuit: " << (cli_.GetSearchGuardRef().IsOpen() ? "open" : "closed") << std::endl;
+
+    return CommandExeStatus::CORRECT;
+}
+
+
 CommandExeStatus Save::Run() {
     if (cli_.Save()) {
         output_manager_.GetStreamRef() << "Save is done" << std::endl;
@@ -104,7 +135,7 @@ CommandExeStatus ScanPoints::Run() {
 CommandExeStatus ListCountry::Run() {
     auto&& country_list = cli_.CountryList();
 
-    if (!output_manager_.PointsJsonOutput(cli_, country_list->get(), "country name", "coutry id")) {
+    if (!output_manager_.PointsOutput(cli_, country_list ? *country_list : YaRaspCli::PointViewList{}, "country name", "coutry id")) {
         output_manager_.GetStreamRef() << "Get list error" << "\n"
             << "try to rescan points" << std::endl;
     }
@@ -117,18 +148,18 @@ CommandExeStatus ListRegion::Run() {
     std::string country_id;
     std::cin >> country_id;
 
-    nlohmann::json list;
+    YaRaspCli::PointViewList list;
     if (country_id == kAllValue) {        
         list = cli_.FindRegion("");
     } else {
         auto&& optional_list = cli_.RegionList(country_id);
 
         if (optional_list) {
-            list = optional_list->get();
+            list = std::move(*optional_list);
         }
 
     }
-    if (!output_manager_.PointsJsonOutput(cli_, list, "region name", "region id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "region name", "region id")) {
         output_manager_.GetStreamRef() << "Can not find region by {" << country_id << "} request" << "\n"
             << "try to rescan points" << std::endl;
     }
@@ -145,7 +176,7 @@ CommandExeStatus ListCity::Run() {
 
     std::string region_id = "";
 
-    nlohmann::json list;
+    YaRaspCli::PointViewList list;
     if (country_id == kAllValue) {        
         list = cli_.FindCity("");
     } else {
@@ -153,11 +184,11 @@ CommandExeStatus ListCity::Run() {
         auto&& optional_list = cli_.CityList(country_id, region_id);
 
         if (optional_list) {
-            list = optional_list->get();
+            list = std::move(*optional_list);
         }
     }
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "city name", "city id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "city name", "city id")) {
         output_manager_.GetStreamRef() << "Can not find city by {" << country_id 
             << (region_id.empty() ? "" : " / ") << region_id
             << "} request" << "\n"
@@ -175,7 +206,7 @@ CommandExeStatus ListStation::Run() {
     std::string region_id = "";
     std::string city_id = "";
 
-    nlohmann::json list;
+    YaRaspCli::PointViewList list;
     if (country_id == kAllValue) {        
         list = cli_.FindStation("");
     } else {
@@ -183,11 +214,11 @@ CommandExeStatus ListStation::Run() {
         auto&& optional_list = cli_.StationList(country_id, region_id, city_id);
 
         if (optional_list) {
-            list = optional_list->get();
+            list = std::move(*optional_list);
         }
     }
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "station name", "station id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "station name", "station id")) {
         output_manager_.GetStreamRef() << "Can not find station by {" << country_id
             << (region_id.empty() ? "" : " / ") << region_id
             << (city_id.empty() ? "" : " / ") << city_id
@@ -209,7 +240,7 @@ CommandExeStatus FindCountry::Run() {
 
     auto&& list = cli_.FindCountry(search_str);
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "country name", "coutry id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "country name", "coutry id")) {
         output_manager_.GetStreamRef() << "Can not find country by {" << search_str << "} request" << "\n"
             << "try to rescan points" << std::endl;
     }
@@ -228,7 +259,7 @@ CommandExeStatus FindRegion::Run() {
 
     auto&& list = cli_.FindRegion(search_str);
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "region name", "region id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "region name", "region id")) {
         output_manager_.GetStreamRef() << "Can not find region by {" << search_str << "} request" << "\n"
             << "try to rescan points" << std::endl;
     }
@@ -247,7 +278,7 @@ CommandExeStatus FindCity::Run() {
 
     auto&& list = cli_.FindCity(search_str);
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "city name", "city id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "city name", "city id")) {
         output_manager_.GetStreamRef() << "Can not find city by {" << search_str << "} request" << "\n"
             << "try to rescan points" << std::endl;
     }
@@ -266,7 +297,7 @@ CommandExeStatus FindStation::Run() {
 
     auto&& list = cli_.FindStation(search_str);
 
-    if (!output_manager_.PointsJsonOutput(cli_, list, "station name", "station id")) {
+    if (!output_manager_.PointsOutput(cli_, list, "station name", "station id")) {
         output_manager_.GetStreamRef() << "Can not find station by {" << search_str << "} request" << "\n"
             << "try to rescan points" << std::endl;
     }
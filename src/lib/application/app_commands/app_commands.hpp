@@ -10,6 +10,9 @@
 #include <compare>
 #include <codecvt>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <iomanip>
 #include <type_traits>
 #include <sstream>
 #include <string>
@@ -96,6 +99,15 @@ class Logdir : public YaRaspApiProjection {
 };
 
 
+class Quota : public YaRaspApiProjection {
+ public:
+    using YaRaspApiProjection::YaRaspApiProjection;
+
+ public:
+    CommandExeStatus Run() override;
+};
+
+
 class Quit : public ::commands::CommandBase {
  public:
     CommandExeStatus Run() override { return CommandExeStatus::EXIT; }
@@ -217,8 +229,130 @@ class ListStation : public ListBase {
 };
 
 
+// yyyy-mm-dd in local time, date format of the api
+inline std::string FormatDate(std::chrono::system_clock::time_point time_point) {
+    std::time_t time = std::chrono::system_clock::to_time_t(time_point);
+    std::stringstream ss_time_buff;
+    ss_time_buff << std::put_time(std::localtime(&time), "%Y-%m-%d");
+    return ss_time_buff.str();
+}
+
+
+inline constexpr size_t kWaysPageSize = 100;
+
+// page of the ways search, discarded unless the status is 200 and the json is well formed
+inline nlohmann::json ParseWaysPage(YaRaspCli& cli, const cpr::Response& resp) {
+    if (resp.status_code != 200) {
+        return nlohmann::json::value_t::discarded;
+    }
+
+    try {
+        return nlohmann::json::parse(resp.text);
+    } catch (nlohmann::json::parse_error& ex) {
+        BOOST_LOG_SEV(cli.GetLoggerRef(), boost::log::trivial::error)
+            << "parse ways json error " << " | "
+            << "id: " << ex.id << " | "
+            << "text: " << ex.what();
+    }
+
+    return nlohmann::json::value_t::discarded;
+}
+
+
+// called with each page of the ways search in page order
+using WaysPageCallbackType = std::function<void(const nlohmann::json&)>;
+
+// way search with its pages merged, the value is empty unless every page is found.
+// The first page tells the total, the rest are fetched in parallel
+// and handed to on_page in order as soon as they arrive
+template<typename CacherType>
+typename CacherType::SearchFuncType MakeWaysSearch(YaRaspCli& cli, std::string from_point_id,
+    std::string to_point_id, std::string date, bool transfers, RequestPriority priority, WaysPageCallbackType on_page = {}) {
+    return [&cli, from_point_id = std::move(from_point_id), to_point_id = std::move(to_point_id),
+        date = std::move(date), transfers, priority, on_page = std::move(on_page)]() {
+        auto resp = cli.ScanWays(from_point_id, to_point_id, date, transfers, "", "", "", 0, kWaysPageSize, false, "", priority);
+        typename CacherType::SearchResultType result{resp.status_code};
+
+        nlohmann::json ways_json = ParseWaysPage(cli, resp);
+
+        if (ways_json.is_discarded()) {
+            return result;
+        }
+
+        if (on_page) {
+            on_page(ways_json);
+        }
+
+        const size_t total = (ways_json.contains(YaRaspJsonPtr::kResultCount) && ways_json.at(YaRaspJsonPtr::kResultCount).is_number_unsigned())
+            ? ways_json.at(YaRaspJsonPtr::kResultCount).get<size_t>() : 0;
+
+        std::vector<WaySearchParams> page_searches;
+
+        for (size_t offset = kWaysPageSize; offset < total; offset += kWaysPageSize) {
+            page_searches.push_back(WaySearchParams{from_point_id, to_point_id, date, transfers, "", "", "", offset, kWaysPageSize});
+        }
+
+        // pages are taken in order, later ones keep downloading meanwhile
+        for (auto& page_future : cli.ScanWaysAsync(page_searches, {}, priority)) {
+            nlohmann::json page_json = ParseWaysPage(cli, page_future.get());
+
+            if (page_json.is_discarded()) {
+                return result;
+            }
+
+            if (on_page) {
+                on_page(page_json);
+            }
+
+            for (const auto& flights_ptr : {YaRaspJsonPtr::kIntervalFlights, YaRaspJsonPtr::kScheduleFlights}) {
+                if (!page_json.contains(flights_ptr) || !page_json.at(flights_ptr).is_array()) {
+                    continue;
+                }
+
+                nlohmann::json& flights = ways_json[flights_ptr];
+
+                if (!flights.is_array()) {
+                    flights = nlohmann::json::array();
+                }
+
+                for (auto& flight : page_json.at(flights_ptr)) {
+                    flights.push_back(std::move(flight));
+                }
+            }
+        }
+
+        if (!page_searches.empty()) {
+            ways_json[YaRaspJsonPtr::kResultLimit] = total;
+            ways_json[YaRaspJsonPtr::kResultOffset] = 0;
+        }
+
+        result.value = std::make_shared<const typename CacherType::ValueType>(
+            std::move(ways_json),
+            std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
+        );
+
+        return result;
+    };
+}
+
+
+// way search run off the main thread by the cache, coalesced with
+// the same search in flight, failed searches give an empty handle
+template<typename CacherType>
+typename CacherType::FetchFuncType MakeWaysFetch(CacherType& cache, YaRaspCli& cli, const typename CacherType::KeyType& key,
+    std::string from_point_id, std::string to_point_id, std::string date, bool transfers) {
+    return [&cache, key, search = MakeWaysSearch<CacherType>(cli, std::move(from_point_id), std::move(to_point_id),
+        std::move(date), transfers, RequestPriority::PREFETCH)]() {
+        return cache.Search(key, search).value;
+    };
+}
+
+
 template<typename CacherType>
 class ListWay : public ListBase {
+ public:
+    static constexpr bool kSearchTransfers = true;
+
  public:
     ListWay(YaRaspCli& cli, YaRaspOutputManager& output_manager,
         CacherType& cache) : ListBase(cli, output_manager), cache_(cache) {
@@ -235,7 +369,12 @@ class ListWay : public ListBase {
 
  private:
     void InputParams();
-    void CacheRefresh();
+    void NoWaysOutput();
+    // ways of the date rendered from the schedule template of the pair,
+    // the template is searched once with days masks
+    typename CacherType::ValueHandle TemplateWays(const typename CacherType::KeyType& key);
+    // prefetch of the likely next queries while the result is read
+    void Speculate();
 
  private:
     CacherType& cache_;
@@ -252,87 +391,179 @@ void ListWay<CacherType>::InputParams() {
     std::cin >> from_point_id_ >> to_point_id_ >> date_;
 };
 
-template<typename CacherType>
-void ListWay<CacherType>::CacheRefresh() {
-    const std::time_t kWayCacheLifetime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::hours(4)).count();
-    std::time_t current_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-
-    std::vector<std::pair<std::time_t, std::string>> key_time_cont;
-    key_time_cont.reserve(cache_.size());
-    for (auto& way_cache : cache_) {
-        key_time_cont.emplace_back(way_cache.second.first.second, way_cache.first);
-    }
-
-    for (auto& key_time : key_time_cont) {
-        if (current_time - key_time.first > kWayCacheLifetime) {
-            cache_.erase(key_time.second);
-        }
-    }
-}
-
 
 template<typename CacherType>
 CommandExeStatus ListWay<CacherType>::Run() {
-    std::stringstream ss_time_buff;
-
     if (date_ == "today") {
-        std::time_t current_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        ss_time_buff << std::put_time(std::localtime(&current_time), "%Y-%m-%d");
-        ss_time_buff >> date_;
+        date_ = FormatDate(std::chrono::system_clock::now());
     } else if (date_ == "tomorrow") {
-        std::time_t current_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() + std::chrono::days(1));
-        ss_time_buff << std::put_time(std::localtime(&current_time), "%Y-%m-%d");
-        ss_time_buff >> date_;
+        date_ = FormatDate(std::chrono::system_clock::now() + std::chrono::days(1));
     }
 
-    nlohmann::json ways_json;
+    auto cache_key = cache_.MakeKey(from_point_id_, to_point_id_, date_, cli_.GetLang(), kSearchTransfers);
+
+    // cached ways are shared with the cache, not copied
+    auto ways = cache_key ? cache_.get(*cache_key) : nullptr;
+    const bool is_cached = static_cast<bool>(ways);
+
+    if (is_cached && cache_.NeedsRefresh(*cache_key, *ways)) {
+        // the cached copy is served now, the fresh one replaces it later
+        cache_.ScheduleRefresh(*cache_key, MakeWaysFetch(cache_, cli_, *cache_key, from_point_id_, to_point_id_, date_, kSearchTransfers));
+    }
 
-    CacheRefresh();
-    auto ways_opt = cache_.get(from_point_id_ + to_point_id_ + date_);
+    if (auto negative_entry = (cache_key && !is_cached) ? cache_.GetNegative(*cache_key) : std::nullopt; negative_entry) {
+        if (negative_entry->reason == CacherType::MissReason::NO_WAYS) {
+            NoWaysOutput();
+        } else {
+            output_manager_.GetStreamRef() << "Ways scan error, response code: " << negative_entry->status_code << std::endl;
+        }
+        return CommandExeStatus::CORRECT;
+    }
+     
+    // a template costs one more request, it pays off for pairs asked again
+    if (!is_cached && cache_key && cache_key->day != CacherType::KeyType::kAnyDay
+      && cache_.IsPairSeen(typename CacherType::QueryType{from_point_id_, to_point_id_, date_})) {
+        ways = TemplateWays(*cache_key);
+    }
      
-    if (ways_opt) {
-        ways_json = ways_opt.value().first;
-    } else {
-        auto resp = cli_.ScanWays(from_point_id_, to_point_id_, date_, true);
+    // pages of a search run here are listed as they arrive
+    size_t listed_page_count = 0;
+    size_t flight_number = 0;
+    bool is_listed = false;
+
+    if (!ways) {
+        auto list_page = [this, &listed_page_count, &flight_number, &is_listed](const nlohmann::json& page_json) {
+            if (listed_page_count++ == 0) {
+                is_listed = output_manager_.WaysTitleOutput(cli_, page_json);
+            }
+
+            if (is_listed) {
+                flight_number = output_manager_.WaysPageOutput(cli_, page_json, flight_number);
+            }
+        };
+
+        auto search = MakeWaysSearch<CacherType>(cli_, from_point_id_, to_point_id_, date_, kSearchTransfers,
+            RequestPriority::INTERACTIVE, std::move(list_page));
+        auto result = cache_key ? cache_.Search(*cache_key, search) : search();
 
-        if (resp.status_code != 200) {
+        // a joined prefetch may be refused by the quota, interactive one is not
+        if (result.is_shared && result.status_code == 0) {
+            result = cache_.Search(*cache_key, search);
+        }
+
+        if (result.status_code != 200) {
+            if (cache_key && CacherType::IsCacheableClientError(result.status_code)) {
+                cache_.InsertNegative(*cache_key, CacherType::MissReason::CLIENT_ERROR, result.status_code);
+            }
             output_manager_.GetStreamRef() << "Ways scan error, check log journal" << std::endl;
             return CommandExeStatus::CORRECT;
         }
 
-        try {
-            ways_json = nlohmann::json::parse(resp.text);
-        } catch (nlohmann::json::parse_error& ex) {
-            BOOST_LOG_SEV(cli_.GetLoggerRef(), boost::log::trivial::error)
-                << "parse ways json error " << " | "
-                << "id: " << ex.id << " | "
-                << "text: " << ex.what();
-            output_manager_.GetStreamRef()
-                << "Ways scan error, check log journal" << "\n"
-                << resp.text << "\n"
-                << std::endl;
+        if (!result.value) {
+            output_manager_.GetStreamRef() << "Ways scan error, check log journal" << std::endl;
             return CommandExeStatus::CORRECT;
         }
+
+        ways = std::move(result.value);
     }
 
-    if (!output_manager_.WaysJsonOutput(cli_, ways_json)) {
-        output_manager_.GetStreamRef() << "Can not find ways by {"
-            << (from_point_id_.empty() ? "" : " from point:  " + from_point_id_ + " / ") 
-            << (to_point_id_.empty() ? "" : " to point:  " + to_point_id_ + " / ") 
-            << (date_.empty() ? "" : " date: " + date_) 
-            << "} request" << "\n"
-            << "try to rescan points" << std::endl;
-    } else {
-        cache_.insert(
-            {from_point_id_ + to_point_id_ + date_},
-            {ways_json, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())}
-        );
+    if (!(listed_page_count ? is_listed : output_manager_.WaysJsonOutput(cli_, ways->first))) {
+        NoWaysOutput();
+
+        if (cache_key && !is_cached) {
+            cache_.InsertNegative(*cache_key, CacherType::MissReason::NO_WAYS);
+        }
+    } else if (cache_key && !is_cached) {
+        cache_.insert(*cache_key, std::move(ways));
     }        
 
+    if (cache_key) {
+        Speculate();
+    }
+
     return CommandExeStatus::CORRECT;
 }
 
 
+template<typename CacherType>
+auto ListWay<CacherType>::TemplateWays(const typename CacherType::KeyType& key) -> typename CacherType::ValueHandle {
+    auto pair_key = cache_.MakeKey(from_point_id_, to_point_id_, "", cli_.GetLang(), kSearchTransfers);
+
+    if (!pair_key) {
+        return {};
+    }
+
+    auto schedule_template = cache_.GetTemplate(*pair_key);
+
+    if (!schedule_template) {
+        // the plain search goes on if the template is refused by the quota,
+        // a pair with more threads than a page gives an invalid template
+        auto search = [this]() {
+            auto resp = cli_.ScanWays(from_point_id_, to_point_id_, "", kSearchTransfers, "", "", "", 0, kWaysPageSize, true, "", RequestPriority::PREFETCH);
+            typename CacherType::SearchResultType result{resp.status_code};
+
+            auto ways_json = nlohmann::json::parse(resp.text, nullptr, false);
+
+            if (resp.status_code == 200 && !ways_json.is_discarded()) {
+                result.value = std::make_shared<const typename CacherType::ValueType>(
+                    std::move(ways_json),
+                    std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
+                );
+            }
+
+            return result;
+        };
+
+        auto result = cache_.Search(CacherType::MakeTemplateKey(*pair_key), search);
+
+        // server errors are retried by the next search of the pair
+        if (result.status_code >= 500 || result.status_code == 0) {
+            return {};
+        }
+
+        schedule_template = cache_.InsertTemplate(*pair_key,
+            result.value ? typename CacherType::TemplateType{result.value->first} : typename CacherType::TemplateType{});
+    }
+
+    if (!schedule_template->Covers(key.day)) {
+        return {};
+    }
+
+    return std::make_shared<const typename CacherType::ValueType>(
+        schedule_template->Render(key.day),
+        std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
+    );
+}
+
+
+template<typename CacherType>
+void ListWay<CacherType>::Speculate() {
+    const typename CacherType::QueryType query{from_point_id_, to_point_id_, date_};
+
+    cache_.ObserveQuery(query);
+
+    for (auto& next_query : cache_.PredictQueries(query)) {
+        auto next_key = cache_.MakeKey(next_query.from_point, next_query.to_point, next_query.date, cli_.GetLang(), kSearchTransfers);
+
+        if (next_key) {
+            cache_.ScheduleSpeculation(*next_key, MakeWaysFetch(cache_, cli_, *next_key, std::move(next_query.from_point),
+                std::move(next_query.to_point), std::move(next_query.date), kSearchTransfers));
+        }
+    }
+}
+
+
+template<typename CacherType>
+void ListWay<CacherType>::NoWaysOutput() {
+    output_manager_.GetStreamRef() << "Can not find ways by {"
+        << (from_point_id_.empty() ? "" : " from point:  " + from_point_id_ + " / ") 
+        << (to_point_id_.empty() ? "" : " to point:  " + to_point_id_ + " / ") 
+        << (date_.empty() ? "" : " date: " + date_) 
+        << "} request" << "\n"
+        << "try to rescan points" << std::endl;
+}
+
+
 template<std::derived_from<ListBase> YaRaspListComand, typename CacherType>
 class YaRaspApiListCreator : public ::commands::CommandCreatorBase {
  public:
@@ -364,6 +595,106 @@ class YaRaspApiListCreator : public ::commands::CommandCreatorBase {
 };
 
 
+class CacheBase : public YaRaspApiProjection {
+ public:
+    using YaRaspApiProjection::YaRaspApiProjection;
+};
+
+
+template<typename CacherType>
+class CacheUsage : public CacheBase {
+ public:
+    CacheUsage(YaRaspCli& cli, YaRaspOutputManager& output_manager, CacherType& cache)
+        : CacheBase(cli, output_manager), cache_(cache) {  };
+
+ public:
+    CommandExeStatus Run() override;
+
+ private:
+    CacherType& cache_;
+};
+
+
+template<typename CacherType>
+CommandExeStatus CacheUsage<CacherType>::Run() {
+    static constexpr double kBytesInMb = 1024.0 * 1024.0;
+
+    output_manager_.GetStreamRef()
+        << "cached ways: " << cache_.size() << "\n"
+        << "memory usage: " << std::fixed << std::setprecision(2) << cache_.weight() / kBytesInMb << " MB"
+        << " / " << cache_.capacity() / kBytesInMb << " MB" << "\n"
+        << "budget used: " << (cache_.capacity() ? 100.0 * cache_.weight() / cache_.capacity() : 0.0) << "%"
+        << std::defaultfloat << std::endl;
+
+    return CommandExeStatus::CORRECT;
+}
+
+
+template<typename CacherType>
+class CacheStatistics : public CacheBase {
+ public:
+    CacheStatistics(YaRaspCli& cli, YaRaspOutputManager& output_manager, CacherType& cache)
+        : CacheBase(cli, output_manager), cache_(cache) {  };
+
+ public:
+    CommandExeStatus Run() override;
+
+ private:
+    CacherType& cache_;
+};
+
+
+template<typename CacherType>
+CommandExeStatus CacheStatistics<CacherType>::Run() {
+    const auto& stats = cache_.stats();
+    const size_t lookup_count = stats.hits + stats.misses;
+    const auto& speculation_stats = cache_.speculation_stats();
+
+    output_manager_.GetStreamRef()
+        << "hits: " << stats.hits << "\n"
+        << "misses: " << stats.misses << "\n"
+        << "hit rate: " << std::fixed << std::setprecision(2)
+        << (lookup_count ? 100.0 * stats.hits / lookup_count : 0.0) << "%" << std::defaultfloat << "\n"
+        << "evictions: " << stats.evictions << "\n"
+        << "expirations: " << stats.expirations << "\n"
+        << "negative hits: " << cache_.negative_stats().hits << "\n"
+        << "background fetches: " << cache_.refresh_count() << "\n"
+        << "coalesced searches: " << cache_.coalesced_count() << "\n"
+        << "schedule template hits: " << cache_.template_stats().hits << "\n"
+        << "speculative prefetches: " << speculation_stats.prefetches << "\n"
+        << "speculation hits: " << speculation_stats.hits << " (" << std::fixed << std::setprecision(2)
+        << (speculation_stats.prefetches ? 100.0 * speculation_stats.hits / speculation_stats.prefetches : 0.0) << "%)"
+        << std::defaultfloat << std::endl;
+
+    return CommandExeStatus::CORRECT;
+}
+
+
+template<std::derived_from<CacheBase> YaRaspCacheComand, typename CacherType>
+class YaRaspApiCacheCreator : public ::commands::CommandCreatorBase {
+ public:
+    YaRaspApiCacheCreator(YaRaspCli& cli, YaRaspOutputManager& output_manager,
+        CacherType& cache)
+            : cli_{cli}, output_manager_{output_manager}, cache_{cache} {  };
+ public:
+    std::shared_ptr<::commands::CommandBase> Create() override {
+        std::string cache_of;
+        std::cin >> cache_of;
+        if (cache_of == "usage") {
+            return std::make_shared<CacheUsage<CacherType>>(cli_, output_manager_, cache_);
+        } else if (cache_of == "stats") {
+            return std::make_shared<CacheStatistics<CacherType>>(cli_, output_manager_, cache_);
+        } else {
+            return std::make_shared<::commands::InvalidCommand>();
+        }
+    };
+ private:
+    YaRaspCli& cli_;
+    YaRaspOutputManager& output_manager_;
+    CacherType& cache_;
+};
+
+
 class FindBase : public YaRaspApiProjection {
  public:
     using YaRaspApiProjection::YaRaspApiProjection;
@@ -542,7 +873,7 @@ class FindWay : public ListBase {
     void InputParams();
 
     template<size_t kResultCount>
-    nlohmann::json FindPoint(const std::wstring& point_raw_name, const nlohmann::json& point_source_json);
+    nlohmann::json FindPoint(const std::wstring& point_raw_name, const YaRaspCli::PointViewList& point_source);
 
     template<size_t kResultCount>
     std::string FindParam(const std::wstring& point_raw_name);
@@ -664,27 +995,29 @@ std::string FindWay<CacherType>::FindParam(const std::wstring& point_raw_name) {
 
 template<typename CacherType>
 template<size_t kResultCount>
-nlohmann::json FindWay<CacherType>::FindPoint(const std::wstring& point_raw_name, const nlohmann::json& point_source_json) {
+nlohmann::json FindWay<CacherType>::FindPoint(const std::wstring& point_raw_name, const YaRaspCli::PointViewList& point_source) {
     FixedPriorityQueue<kResultCount> result_cont;
     std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
 
-    for (const nlohmann::json& point : point_source_json) {
-        if (point.contains(YaRaspJsonPtr::kPointName)) {
-            // std::wstring w_temp = converter.from_bytes(
-            //     point.at(YaRaspJsonPtr::kPointName).get<const wchar_t*>()
-            // );
+    for (const auto& point_view : point_source) {
+        nlohmann::json point;
+        point[YaRaspJsonPtr::kPointId] = point_view.code;
+        point[YaRaspJsonPtr::kPointName] = point_view.title;
 
-            // auto temp_ptr = static_cast<std::wstring>(point.at(YaRaspJsonPtr::kPointName));
-            // auto temp_ptr = point.at(YaRaspJsonPtr::kPointName).get<const wchar_t*>();
+        // std::wstring w_temp = converter.from_bytes(
+        //     point.at(YaRaspJsonPtr::kPointName).get<const wchar_t*>()
+        // );
 
-            size_t edit_lenght = 0;
-                // GetEditLenght(point_raw_name, temp_ptr);
-            
-            if (edit_lenght == 0) {
-                return nlohmann::json::array({point});
-            } else {
-                result_cont.emplace(edit_lenght, point);
-            }
+        // auto temp_ptr = static_cast<std::wstring>(point.at(YaRaspJsonPtr::kPointName));
+        // auto temp_ptr = point.at(YaRaspJsonPtr::kPointName).get<const wchar_t*>();
+
+        size_t edit_lenght = 0;
+            // GetEditLenght(point_raw_name, temp_ptr);
+        
+        if (edit_lenght == 0) {
+            return nlohmann::json::array({point});
+        } else {
+            result_cont.emplace(edit_lenght, point);
         }
     }
 
@@ -1,5 +1,7 @@
 #include "console_cli_app.hpp"
 
+#include <chrono>
+#include <cstddef>
 #include <utility>
 #include <string>
 
@@ -13,13 +15,15 @@ namespace waybuilder {
 namespace __detail {
 
 Application<ApplicationCategories::CONSOLE_CLI>::Application(std::string api_key, std::string point_list_path, std::string api_cfg_path) 
-  : cli_{api_key, point_list_path, api_cfg_path, "ru_RU"}, output_manager_{std::cout} {
+  : cli_{api_key, point_list_path, api_cfg_path, "ru_RU"}, output_manager_{std::cout},
+    cache_{kWayCacheDirPath, kWayCacheLifetime, cli_.GetCacheGrace(), cli_.GetPrefetchBudget(), cli_.GetCacheBudget()} {
     CommandRegistrate();
 };
 
 
 Application<ApplicationCategories::CONSOLE_CLI>::Application(std::string api_cfg_path)
-    : cli_{api_cfg_path}, output_manager_{std::cout} {
+    : cli_{api_cfg_path}, output_manager_{std::cout},
+        cache_{kWayCacheDirPath, kWayCacheLifetime, cli_.GetCacheGrace(), cli_.GetPrefetchBudget(), cli_.GetCacheBudget()} {
     CommandRegistrate();
 }
 
@@ -33,13 +37,45 @@ void Application<ApplicationCategories::CONSOLE_CLI>::CommandRegistrate() {
         std::pair<std::string, commands::YaRaspCommandCreator<commands::ScanBase>>{"scan", {cli_, output_manager_}},
         std::pair<std::string, commands::YaRaspApiListCreator<commands::ListBase, CacheType>>{"list", {cli_, output_manager_, cache_}},
         std::pair<std::string, commands::YaRaspApiFindCreator<commands::FindBase, CacheType>>{"find", {cli_, output_manager_, cache_}},
+        std::pair<std::string, commands::YaRaspApiCacheCreator<commands::CacheBase, CacheType>>{"cache", {cli_, output_manager_, cache_}},
+        std::pair<std::string, commands::YaRaspCommandCreator<commands::Quota>>{"quota", {cli_, output_manager_}},
         std::pair<std::string, commands::YaRaspCommandCreator<commands::Logdir>>{"logdir", {cli_, output_manager_}}
     );
 };
 
+size_t Application<ApplicationCategories::CONSOLE_CLI>::WarmUp() {
+    static constexpr bool kSearchTransfers = commands::ListWay<CacheType>::kSearchTransfers;
+
+    const size_t budget = cli_.GetWarmUpBudget();
+    size_t scheduled_count = 0;
+
+    // earlier days first, a short budget covers every route for today
+    for (size_t day_index = 0; day_index < kWarmUpDays; ++day_index) {
+        const std::string date = commands::FormatDate(std::chrono::system_clock::now() + std::chrono::days(day_index));
+
+        for (const auto& [from_point_id, to_point_id] : cli_.GetWarmUpRoutes()) {
+            if (scheduled_count == budget) {
+                return scheduled_count;
+            }
+
+            auto cache_key = cache_.MakeKey(from_point_id, to_point_id, date, cli_.GetLang(), kSearchTransfers);
+
+            if (cache_key && cache_.SchedulePrefetch(*cache_key,
+                commands::MakeWaysFetch(cache_, cli_, *cache_key, from_point_id, to_point_id, date, kSearchTransfers))) {
+                ++scheduled_count;
+            }
+        }
+    }
+
+    return scheduled_count;
+}
+
+
 ExitStatus Application<ApplicationCategories::CONSOLE_CLI>::Run() {
     static constexpr std::string prefix_lable = "[waybuilder]>  ";
 
+    WarmUp();
+
     while (true) {
         std::cout << prefix_lable;
 
@@ -12,6 +12,10 @@
 #include <ya_rasp_cli.hpp>
 #include <output_manager.hpp>
 #include <lru_cache.hpp>
+#include <cache_policy.hpp>
+#include <way_cache.hpp>
+#include <way_cache_key.hpp>
+#include <way_cache_weigher.hpp>
 
 namespace waybuilder {
 
@@ -20,8 +24,15 @@ namespace __detail {
 template<>
 class Application<ApplicationCategories::CONSOLE_CLI> {
  public:
-   static constexpr size_t kCacheSize = 30;
-   using CacheType = LruCache<std::string, std::pair<nlohmann::json, std::time_t>, kCacheSize>;
+   static constexpr std::time_t kWayCacheLifetime = 4 * 60 * 60;
+   static inline const std::string kWayCacheDirPath = "./cache/";
+   // operators start a shift with today and tomorrow routes
+   static constexpr size_t kWarmUpDays = 2;
+
+   // W-TinyLFU keeps hot routes cached through bursts of one-off lookups
+   using MemCacheType = LruCache<WayCacheKey, std::pair<nlohmann::json, std::time_t>,
+      YaRaspCli::kDefaultCacheBudget, WayCacheWeigher, WTinyLfuPolicy<WayCacheKey>>;
+   using CacheType = WayCache<MemCacheType>;
  public:
     Application(std::string api_key, std::string point_list_path, std::string api_cfg_path);
     Application(std::string api_cfg_path);
@@ -31,6 +42,8 @@ class Application<ApplicationCategories::CONSOLE_CLI> {
 
  private:
     void CommandRegistrate();
+    // prefetch of configured routes in background, within warm up budget
+    size_t WarmUp();
 
  private:
     ::commands::CommandFabric commands_;
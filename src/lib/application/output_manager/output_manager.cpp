@@ -18,11 +18,11 @@ YaRaspOutputManager::YaRaspOutputManager() : output_stream_(std::cout) {};
 YaRaspOutputManager::YaRaspOutputManager(std::ostream& output_stream) : output_stream_(output_stream) {};
 
 
-bool YaRaspOutputManager::PointsJsonOutput(YaRaspCli& cli, const nlohmann::json& points_json,
+bool YaRaspOutputManager::PointsOutput(YaRaspCli& cli, const YaRaspCli::PointViewList& points,
     const std::string& name_colom, const std::string& id_colom) {
     static constexpr size_t kCollomSpaceOffset = 20;
 
-    if (points_json.empty()) {
+    if (points.empty()) {
         BOOST_LOG_SEV(cli.GetLoggerRef(), boost::log::trivial::error) 
             << "output point error, list of points is empty"; 
         return false;
@@ -30,28 +30,25 @@ bool YaRaspOutputManager::PointsJsonOutput(YaRaspCli& cli, const nlohmann::json&
 
     output_stream_ << name_colom << " " << std::setw(kCollomSpaceOffset) << id_colom << std::endl;
 
-    try {
-        for (auto&& point : points_json) {
-            if (point.contains(YaRaspJsonPtr::kPointName) && point.contains(YaRaspJsonPtr::kPointId)) {
-                output_stream_
-                    << point.at(YaRaspJsonPtr::kPointName).get<std::string>() << std::setw(kCollomSpaceOffset)
-                    << point.at(YaRaspJsonPtr::kPointId).get<std::string>() << std::endl;
-            }
-        }
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(cli.GetLoggerRef(), boost::log::trivial::error) 
-            << "output point error" << " | " 
-            << "exception id: " << ex.id << " | "
-            << ex.what();
-        return false;
+    for (const auto& point : points) {
+        output_stream_ << point.title << std::setw(kCollomSpaceOffset) << point.code << std::endl;
     }
-    output_stream_ << "Total count: " << points_json.size() << std::endl;
+
+    output_stream_ << "Total count: " << points.size() << std::endl;
     return true;
 };
   
 
 bool YaRaspOutputManager::WaysJsonOutput(YaRaspCli& cli, const nlohmann::json& ways_json) {
-    // title output
+    if (!WaysTitleOutput(cli, ways_json))
+        return false;
+
+    WaysPageOutput(cli, ways_json, 0);
+    return true;
+}
+
+
+bool YaRaspOutputManager::WaysTitleOutput(YaRaspCli& cli, const nlohmann::json& ways_json) {
     if (ways_json.contains(YaRaspJsonPtr::kResultCount) && ways_json.contains(YaRaspJsonPtr::kRequestFromPointName)
         && ways_json.contains(YaRaspJsonPtr::kRequestToPointName) && ways_json.contains(YaRaspJsonPtr::kRequestDate)) {
         output_stream_ << "Ways list" << "\n"
@@ -74,17 +71,20 @@ bool YaRaspOutputManager::WaysJsonOutput(YaRaspCli& cli, const nlohmann::json& w
         return false;
     }
 
+    return true;
+}
 
-    size_t flight_number = 0;
+
+size_t YaRaspOutputManager::WaysPageOutput(YaRaspCli& cli, const nlohmann::json& page_json, size_t flight_number) {
     constexpr size_t kInfoIdent = 4;
     const static nlohmann::json::json_pointer kFromJsonPtr{"/from"};
     const static nlohmann::json::json_pointer kToJsonPtr{"/to"};
 
 
     // Interval flights
-    if (ways_json.contains(YaRaspJsonPtr::kIntervalFlights) && ways_json.at(YaRaspJsonPtr::kIntervalFlights).size()) {
+    if (page_json.contains(YaRaspJsonPtr::kIntervalFlights) && page_json.at(YaRaspJsonPtr::kIntervalFlights).size()) {
         output_stream_ << "Interval flights list: " << std::endl;
-        for (auto& flight : ways_json.at(YaRaspJsonPtr::kIntervalFlights)) {
+        for (auto& flight : page_json.at(YaRaspJsonPtr::kIntervalFlights)) {
             try {                    
                 output_stream_ << "[" <<  flight_number << "]" << "\n";
                 output_stream_ 
@@ -106,9 +106,9 @@ bool YaRaspOutputManager::WaysJsonOutput(YaRaspCli& cli, const nlohmann::json& w
     }
 
     // Schedule flights
-    if (ways_json.contains(YaRaspJsonPtr::kScheduleFlights) && ways_json.at(YaRaspJsonPtr::kScheduleFlights).size()) {
+    if (page_json.contains(YaRaspJsonPtr::kScheduleFlights) && page_json.at(YaRaspJsonPtr::kScheduleFlights).size()) {
         output_stream_ << "Schedule flights list: " << std::endl;
-        for (auto& flight : ways_json.at(YaRaspJsonPtr::kScheduleFlights)) {
+        for (auto& flight : page_json.at(YaRaspJsonPtr::kScheduleFlights)) {
             try {                    
                 output_stream_ << "[" <<  flight_number << "]" << "\n";
                 ShedueFlightOutput(flight);
@@ -124,7 +124,7 @@ bool YaRaspOutputManager::WaysJsonOutput(YaRaspCli& cli, const nlohmann::json& w
     }
 
 
-    return true;
+    return flight_number;
 }
 
 
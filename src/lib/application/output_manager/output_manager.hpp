@@ -17,13 +17,18 @@ class YaRaspOutputManager {
     YaRaspOutputManager(std::ostream& output_stream);
 
  public:
-    bool PointsJsonOutput(YaRaspCli& cli, const nlohmann::json& points_json,
+    bool PointsOutput(YaRaspCli& cli, const YaRaspCli::PointViewList& points,
         const std::string& name_colom, const std::string& id_colom);
 
     void ShedueFlightOutput(const nlohmann::json& flight_json);
 
     bool WaysJsonOutput(YaRaspCli& cli, const nlohmann::json& ways_json);
 
+    // title of a paged result, false if there are no ways
+    bool WaysTitleOutput(YaRaspCli& cli, const nlohmann::json& ways_json);
+    // flights of one page numbered from flight_number, gives the next number
+    size_t WaysPageOutput(YaRaspCli& cli, const nlohmann::json& page_json, size_t flight_number);
+
  public:
     operator std::ostream&() { return output_stream_; };
     std::ostream& GetStreamRef() { return output_stream_; };
@@ -0,0 +1,414 @@
+#ifndef _CACHE_POLICY_HPP_
+#define _CACHE_POLICY_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+#include "count_min_sketch.hpp"
+
+namespace waybuilder {
+
+namespace __detail {
+
+// Eviction policies of LruCache. A policy tracks resident keys with their
+// weights and decides which one leaves next, all operations are O(1):
+//   Handle Insert(key, weight) - new resident entry
+//   void Access(Handle&)       - hit of a resident entry
+//   void Record(key)           - any lookup of key, hit or miss
+//   const KeyType& Victim()    - next entry to evict before a new key enters,
+//                                policy must not be empty
+//   void Evict(Handle)         - entry evicted on capacity pressure
+//   void Erase(Handle)         - entry erased or expired
+//   void SetCapacity(size_t), void clear()
+
+template<typename KeyType>
+class LruPolicy {
+ private:
+    using ListType = std::list<KeyType>;
+
+ public:
+    using Handle = ListType::iterator;
+
+ public:
+    Handle Insert(const KeyType& key, size_t) { list_.push_front(key); return list_.begin(); };
+
+    void Access(Handle& handle) {
+        if (handle != list_.begin()) {
+            // relink the node, list iterators stay valid
+            list_.splice(list_.begin(), list_, handle);
+        }
+    };
+
+    void Record(const KeyType&) {  };
+
+    const KeyType& Victim() const { return list_.back(); };
+
+    void Evict(Handle handle) { list_.erase(handle); };
+
+    void Erase(Handle handle) { list_.erase(handle); };
+
+    void SetCapacity(size_t) {  };
+
+    void clear() { list_.clear(); };
+
+ private:
+    ListType list_;
+};
+
+
+// W-TinyLFU: every new entry lands in a small LRU window, entries leaving the
+// window move on to the main segmented LRU (probation + protected).
+// When the cache is full, the entry a new key pushes out of the window
+// competes with the probation victim by sketch frequency and the loser is
+// evicted, so one-off keys do not push out frequently used ones.
+template<typename KeyType>
+class WTinyLfuPolicy {
+ private:
+    static constexpr size_t kWindowPercent = 1;
+    static constexpr size_t kProtectedPercent = 80;
+
+    enum class Segment : uint8_t { WINDOW, PROBATION, PROTECTED };
+
+    struct Node {
+        KeyType key;
+        size_t weight;
+        Segment segment;
+    };
+
+    using ListType = std::list<Node>;
+
+ public:
+    using Handle = ListType::iterator;
+
+ public:
+    Handle Insert(const KeyType& key, size_t weight);
+    void Access(Handle& handle);
+    void Record(const KeyType& key) { sketch_.Increment(key); };
+    const KeyType& Victim() const;
+    void Evict(Handle handle) { Erase(handle); };
+    void Erase(Handle handle);
+
+    void SetCapacity(size_t capacity);
+    void clear();
+
+ private:
+    void Move(Handle handle, ListType& list, Segment segment);
+
+ private:
+    ListType window_;
+    ListType probation_;
+    ListType protected_;
+
+    size_t window_weight_ = 0;
+    size_t protected_weight_ = 0;
+    size_t window_capacity_ = 0;
+    size_t protected_capacity_ = 0;
+    size_t entry_count_ = 0;
+
+    CountMinSketch<KeyType> sketch_;
+};
+
+
+template<typename KeyType>
+void WTinyLfuPolicy<KeyType>::Move(Handle handle, ListType& list, Segment segment) {
+    ListType& source_list = (handle->segment == Segment::WINDOW) ? window_
+        : (handle->segment == Segment::PROBATION) ? probation_ : protected_;
+
+    if (handle->segment == Segment::WINDOW) {
+        window_weight_ -= handle->weight;
+    } else if (handle->segment == Segment::PROTECTED) {
+        protected_weight_ -= handle->weight;
+    }
+
+    list.splice(list.begin(), source_list, handle);
+    handle->segment = segment;
+
+    if (segment == Segment::WINDOW) {
+        window_weight_ += handle->weight;
+    } else if (segment == Segment::PROTECTED) {
+        protected_weight_ += handle->weight;
+    }
+}
+
+
+template<typename KeyType>
+auto WTinyLfuPolicy<KeyType>::Insert(const KeyType& key, size_t weight) -> Handle {
+    sketch_.EnsureCapacity(++entry_count_);
+
+    window_.push_front(Node{key, weight, Segment::WINDOW});
+    window_weight_ += weight;
+
+    Handle handle = window_.begin();
+
+    // window overflow becomes admission candidates at the head of probation
+    while (window_weight_ > window_capacity_ && window_.size() > 1) {
+        Move(std::prev(window_.end()), probation_, Segment::PROBATION);
+    }
+
+    return handle;
+}
+
+
+template<typename KeyType>
+void WTinyLfuPolicy<KeyType>::Access(Handle& handle) {
+    switch (handle->segment) {
+        case Segment::WINDOW:
+            Move(handle, window_, Segment::WINDOW);
+            break;
+        case Segment::PROBATION:
+            Move(handle, protected_, Segment::PROTECTED);
+
+            while (protected_weight_ > protected_capacity_ && protected_.size() > 1) {
+                Move(std::prev(protected_.end()), probation_, Segment::PROBATION);
+            }
+            break;
+        case Segment::PROTECTED:
+            Move(handle, protected_, Segment::PROTECTED);
+            break;
+    }
+}
+
+
+template<typename KeyType>
+const KeyType& WTinyLfuPolicy<KeyType>::Victim() const {
+    // the least recent entry of the main segments, probation first
+    const ListType& main_list = probation_.empty() ? protected_ : probation_;
+
+    if (main_list.empty()) {
+        return window_.back().key;
+    }
+
+    // a window with room takes the new key without pushing an entry out
+    if (window_.empty() || window_weight_ < window_capacity_) {
+        return main_list.back().key;
+    }
+
+    // the entry leaving the window enters only by beating the victim,
+    // ties keep the resident, so a scan can not flush the main segments
+    const KeyType& candidate = window_.back().key;
+    const KeyType& victim = main_list.back().key;
+
+    return sketch_.Frequency(candidate) > sketch_.Frequency(victim) ? victim : candidate;
+}
+
+
+template<typename KeyType>
+void WTinyLfuPolicy<KeyType>::Erase(Handle handle) {
+    switch (handle->segment) {
+        case Segment::WINDOW:
+            window_weight_ -= handle->weight;
+            window_.erase(handle);
+            break;
+        case Segment::PROBATION:
+            probation_.erase(handle);
+            break;
+        case Segment::PROTECTED:
+            protected_weight_ -= handle->weight;
+            protected_.erase(handle);
+            break;
+    }
+
+    --entry_count_;
+}
+
+
+template<typename KeyType>
+void WTinyLfuPolicy<KeyType>::SetCapacity(size_t capacity) {
+    window_capacity_ = std::max<size_t>(capacity * kWindowPercent / 100, 1);
+    protected_capacity_ = (capacity - std::min(capacity, window_capacity_)) * kProtectedPercent / 100;
+}
+
+
+template<typename KeyType>
+void WTinyLfuPolicy<KeyType>::clear() {
+    window_.clear();
+    probation_.clear();
+    protected_.clear();
+
+    window_weight_ = protected_weight_ = entry_count_ = 0;
+
+    sketch_.clear();
+}
+
+
+// ARC: recent (seen once) and frequent (seen again) LRU lists, plus ghost
+// lists remembering keys evicted from each. A hit in a ghost list moves the
+// recent list target size towards the list that would have kept the key.
+// Sizes are measured in entry weights.
+template<typename KeyType>
+class ArcPolicy {
+ private:
+    enum class Segment : uint8_t { RECENT, FREQUENT };
+
+    struct Node {
+        KeyType key;
+        size_t weight;
+        Segment segment;
+    };
+
+    using ListType = std::list<Node>;
+
+ public:
+    using Handle = ListType::iterator;
+
+ public:
+    Handle Insert(const KeyType& key, size_t weight);
+    void Access(Handle& handle);
+    void Record(const KeyType&) {  };
+    const KeyType& Victim() const;
+    void Evict(Handle handle);
+    void Erase(Handle handle);
+
+    void SetCapacity(size_t capacity);
+    void clear();
+
+ private:
+    ListType& GetList(Segment segment) { return segment == Segment::RECENT ? recent_ : frequent_; };
+    ListType& GetGhostList(Segment segment) { return segment == Segment::RECENT ? recent_ghosts_ : frequent_ghosts_; };
+    size_t& GetWeight(Segment segment) { return segment == Segment::RECENT ? recent_weight_ : frequent_weight_; };
+    size_t& GetGhostWeight(Segment segment) { return segment == Segment::RECENT ? recent_ghost_weight_ : frequent_ghost_weight_; };
+
+    void DropGhost(Handle ghost);
+    void TrimGhosts();
+
+ private:
+    ListType recent_;
+    ListType frequent_;
+    ListType recent_ghosts_;
+    ListType frequent_ghosts_;
+    std::unordered_map<KeyType, Handle> ghosts_;
+
+    size_t recent_weight_ = 0;
+    size_t frequent_weight_ = 0;
+    size_t recent_ghost_weight_ = 0;
+    size_t frequent_ghost_weight_ = 0;
+
+    size_t capacity_ = 0;
+    size_t recent_target_ = 0;
+};
+
+
+template<typename KeyType>
+auto ArcPolicy<KeyType>::Insert(const KeyType& key, size_t weight) -> Handle {
+    Segment segment = Segment::RECENT;
+
+    if (auto ghost_itr = ghosts_.find(key); ghost_itr != ghosts_.end()) {
+        segment = Segment::FREQUENT;
+
+        if (ghost_itr->second->segment == Segment::RECENT) {
+            const size_t ratio = std::max<size_t>(1, frequent_ghost_weight_ / std::max<size_t>(recent_ghost_weight_, 1));
+            recent_target_ = std::min(capacity_, recent_target_ + weight * ratio);
+        } else {
+            const size_t ratio = std::max<size_t>(1, recent_ghost_weight_ / std::max<size_t>(frequent_ghost_weight_, 1));
+            recent_target_ -= std::min(recent_target_, weight * ratio);
+        }
+
+        DropGhost(ghost_itr->second);
+    }
+
+    ListType& list = GetList(segment);
+    list.push_front(Node{key, weight, segment});
+    GetWeight(segment) += weight;
+
+    return list.begin();
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::Access(Handle& handle) {
+    if (handle->segment == Segment::RECENT) {
+        recent_weight_ -= handle->weight;
+        frequent_weight_ += handle->weight;
+        frequent_.splice(frequent_.begin(), recent_, handle);
+        handle->segment = Segment::FREQUENT;
+    } else if (handle != frequent_.begin()) {
+        frequent_.splice(frequent_.begin(), frequent_, handle);
+    }
+}
+
+
+template<typename KeyType>
+const KeyType& ArcPolicy<KeyType>::Victim() const {
+    if (!recent_.empty() && (recent_weight_ > recent_target_ || frequent_.empty())) {
+        return recent_.back().key;
+    }
+
+    return frequent_.back().key;
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::Evict(Handle handle) {
+    const Segment segment = handle->segment;
+
+    GetWeight(segment) -= handle->weight;
+    GetGhostWeight(segment) += handle->weight;
+
+    ListType& ghost_list = GetGhostList(segment);
+    ghost_list.splice(ghost_list.begin(), GetList(segment), handle);
+    ghosts_[handle->key] = handle;
+
+    TrimGhosts();
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::Erase(Handle handle) {
+    GetWeight(handle->segment) -= handle->weight;
+    GetList(handle->segment).erase(handle);
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::DropGhost(Handle ghost) {
+    GetGhostWeight(ghost->segment) -= ghost->weight;
+    ghosts_.erase(ghost->key);
+    GetGhostList(ghost->segment).erase(ghost);
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::TrimGhosts() {
+    // recent side holds at most capacity, both sides at most twice of it
+    while (!recent_ghosts_.empty() && recent_weight_ + recent_ghost_weight_ > capacity_) {
+        DropGhost(std::prev(recent_ghosts_.end()));
+    }
+
+    while (!frequent_ghosts_.empty()
+        && recent_weight_ + frequent_weight_ + recent_ghost_weight_ + frequent_ghost_weight_ > 2 * capacity_) {
+        DropGhost(std::prev(frequent_ghosts_.end()));
+    }
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::SetCapacity(size_t capacity) {
+    capacity_ = capacity;
+    recent_target_ = std::min(recent_target_, capacity_);
+
+    TrimGhosts();
+}
+
+
+template<typename KeyType>
+void ArcPolicy<KeyType>::clear() {
+    recent_.clear();
+    frequent_.clear();
+    recent_ghosts_.clear();
+    frequent_ghosts_.clear();
+    ghosts_.clear();
+
+    recent_weight_ = frequent_weight_ = recent_ghost_weight_ = frequent_ghost_weight_ = 0;
+    recent_target_ = 0;
+}
+
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _CACHE_POLICY_HPP_
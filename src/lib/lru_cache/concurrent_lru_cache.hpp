@@ -0,0 +1,203 @@
+#ifndef _CONCURRENT_LRU_CACHE_HPP_
+#define _CONCURRENT_LRU_CACHE_HPP_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "lru_cache.hpp"
+
+namespace waybuilder {
+
+namespace __detail {
+
+// Thread safe LruCache: keys are striped across ShardCount shards, every shard
+// is an independent LruCache with its own mutex and recency order, so threads
+// touching different shards do not contend.
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount = 16,
+    typename HashType = std::hash<KeyType>, typename PolicyType = LruPolicy<KeyType>>
+class ConcurrentLruCache {
+ private:
+    static_assert(std::has_single_bit(ShardCount), "shard count must be a power of two");
+    static_assert(CacheSize >= ShardCount, "every shard needs at least one entry");
+
+    static constexpr size_t kShardCacheSize = CacheSize / ShardCount;
+    static constexpr size_t kShardShift = sizeof(uint64_t) * 8 - std::countr_zero(ShardCount);
+
+    static constexpr size_t kCacheLineSize = 64;
+
+    using ShardCacheType = LruCache<KeyType, ValueType, kShardCacheSize, UnitWeigher<ValueType>, PolicyType>;
+
+    struct alignas(kCacheLineSize) Shard {
+        mutable std::mutex mutex;
+        ShardCacheType cache;
+    };
+
+ public:
+    using ValueHandle = ShardCacheType::ValueHandle;
+
+ public:
+    size_t size() const;
+
+    bool contains(const KeyType& key) const;
+
+    bool empty() const { return size() == 0; };
+
+    void clear();
+
+    // counters summed over shards
+    CacheStats stats() const;
+
+ public:
+    bool insert(const KeyType& key, const ValueType& value, std::time_t ttl = 0);
+    bool insert(const KeyType& key, ValueHandle value, std::time_t ttl = 0);
+    void erase(const KeyType& key);
+    std::optional<ValueType> get(const KeyType& key);
+    ValueHandle get_handle(const KeyType& key);
+
+    // visits every entry, only one shard is locked at a time
+    template<typename FuncType>
+    void for_each(FuncType&& func);
+
+ public:
+    static constexpr size_t shard_count() { return ShardCount; };
+
+ private:
+    Shard& GetShard(const KeyType& key);
+    const Shard& GetShard(const KeyType& key) const;
+
+ private:
+    std::array<Shard, ShardCount> shards_;
+    [[no_unique_address]] HashType hasher_;
+};
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+auto ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::GetShard(const KeyType& key) -> Shard& {
+    if constexpr (ShardCount == 1) {
+        return shards_[0];
+    } else {
+        // fibonacci hashing, the shard caches use the low hash bits themselves
+        const uint64_t mixed_hash = static_cast<uint64_t>(hasher_(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[mixed_hash >> kShardShift];
+    }
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+auto ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::GetShard(const KeyType& key) const -> const Shard& {
+    return const_cast<ConcurrentLruCache*>(this)->GetShard(key);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+size_t ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::size() const {
+    size_t total_size = 0;
+
+    for (auto& shard : shards_) {
+        std::lock_guard lock{shard.mutex};
+        total_size += shard.cache.size();
+    }
+
+    return total_size;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+bool ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::contains(const KeyType& key) const {
+    const Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.cache.contains(key);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+void ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard lock{shard.mutex};
+        shard.cache.clear();
+    }
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+CacheStats ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::stats() const {
+    CacheStats total_stats;
+
+    for (auto& shard : shards_) {
+        std::lock_guard lock{shard.mutex};
+        const CacheStats& shard_stats = shard.cache.stats();
+
+        total_stats.hits += shard_stats.hits;
+        total_stats.misses += shard_stats.misses;
+        total_stats.evictions += shard_stats.evictions;
+        total_stats.expirations += shard_stats.expirations;
+    }
+
+    return total_stats;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+bool ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::insert(const KeyType& key, const ValueType& value, std::time_t ttl) {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.cache.insert(key, value, ttl);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+bool ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::insert(const KeyType& key, ValueHandle value, std::time_t ttl) {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.cache.insert(key, std::move(value), ttl);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+void ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::erase(const KeyType& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    shard.cache.erase(key);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+std::optional<ValueType> ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::get(const KeyType& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.cache.get(key);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+auto ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::get_handle(const KeyType& key) -> ValueHandle {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.cache.get_handle(key);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, size_t ShardCount, typename HashType, typename PolicyType>
+template<typename FuncType>
+void ConcurrentLruCache<KeyType, ValueType, CacheSize, ShardCount, HashType, PolicyType>::for_each(FuncType&& func) {
+    for (auto& shard : shards_) {
+        std::lock_guard lock{shard.mutex};
+        for (auto& entry : shard.cache) {
+            func(entry);
+        }
+    }
+}
+
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _CONCURRENT_LRU_CACHE_HPP_
@@ -0,0 +1,143 @@
+#ifndef _COUNT_MIN_SKETCH_HPP_
+#define _COUNT_MIN_SKETCH_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace waybuilder {
+
+namespace __detail {
+
+// Approximate access frequency of keys: kDepth rows of saturating 4 bit
+// counters, the estimate is the minimum over rows. All counters are halved
+// after kSampleFactor * width increments, so old popularity fades out.
+template<typename KeyType, typename HashType = std::hash<KeyType>>
+class CountMinSketch {
+ private:
+    static constexpr size_t kDepth = 4;
+    static constexpr size_t kMinWidth = 64;
+    static constexpr size_t kSampleFactor = 10;
+    static constexpr uint8_t kMaxCount = 15;
+
+    static constexpr std::array<uint64_t, kDepth> kSeeds = {
+        0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+    };
+
+ public:
+    CountMinSketch() { Resize(kMinWidth); };
+
+ public:
+    // grows the rows to fit entry_count keys, counters are reset on growth
+    void EnsureCapacity(size_t entry_count);
+
+    void Increment(const KeyType& key);
+    uint8_t Frequency(const KeyType& key) const;
+
+    void clear();
+
+ private:
+    void Resize(size_t width);
+    void Age();
+    size_t CounterIndex(size_t hash, size_t row) const;
+
+ private:
+    std::vector<uint8_t> counters_;
+    size_t width_ = 0;
+    size_t additions_ = 0;
+    [[no_unique_address]] HashType hasher_;
+};
+
+
+template<typename KeyType, typename HashType>
+void CountMinSketch<KeyType, HashType>::EnsureCapacity(size_t entry_count) {
+    if (entry_count > width_) {
+        Resize(std::bit_ceil(entry_count));
+    }
+}
+
+
+template<typename KeyType, typename HashType>
+void CountMinSketch<KeyType, HashType>::Resize(size_t width) {
+    width_ = std::max(width, kMinWidth);
+    counters_.assign(width_ * kDepth, 0);
+    additions_ = 0;
+}
+
+
+template<typename KeyType, typename HashType>
+void CountMinSketch<KeyType, HashType>::clear() {
+    std::fill(counters_.begin(), counters_.end(), 0);
+    additions_ = 0;
+}
+
+
+template<typename KeyType, typename HashType>
+size_t CountMinSketch<KeyType, HashType>::CounterIndex(size_t hash, size_t row) const {
+    uint64_t row_hash = (static_cast<uint64_t>(hash) + row) * kSeeds[row];
+    row_hash ^= row_hash >> 32;
+    return row * width_ + (row_hash & (width_ - 1));
+}
+
+
+template<typename KeyType, typename HashType>
+void CountMinSketch<KeyType, HashType>::Increment(const KeyType& key) {
+    const size_t hash = hasher_(key);
+
+    std::array<size_t, kDepth> indexes;
+    uint8_t min_count = kMaxCount;
+
+    for (size_t row = 0; row < kDepth; ++row) {
+        indexes[row] = CounterIndex(hash, row);
+        min_count = std::min(min_count, counters_[indexes[row]]);
+    }
+
+    if (min_count == kMaxCount) {
+        return;
+    }
+
+    // conservative update: only the smallest counters grow
+    for (size_t index : indexes) {
+        if (counters_[index] == min_count) {
+            ++counters_[index];
+        }
+    }
+
+    if (++additions_ >= kSampleFactor * width_) {
+        Age();
+    }
+}
+
+
+template<typename KeyType, typename HashType>
+uint8_t CountMinSketch<KeyType, HashType>::Frequency(const KeyType& key) const {
+    const size_t hash = hasher_(key);
+    uint8_t min_count = kMaxCount;
+
+    for (size_t row = 0; row < kDepth; ++row) {
+        min_count = std::min(min_count, counters_[CounterIndex(hash, row)]);
+    }
+
+    return min_count;
+}
+
+
+template<typename KeyType, typename HashType>
+void CountMinSketch<KeyType, HashType>::Age() {
+    for (auto& counter : counters_) {
+        counter >>= 1;
+    }
+
+    additions_ /= 2;
+}
+
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _COUNT_MIN_SKETCH_HPP_
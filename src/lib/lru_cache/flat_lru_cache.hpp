@@ -0,0 +1,322 @@
+#ifndef _FLAT_LRU_CACHE_HPP_
+#define _FLAT_LRU_CACHE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace waybuilder {
+
+namespace __detail {
+
+// LruCache with the same interface, but all entries live in one slot array
+// allocated at construction. Keys are found by open addressing (linear probing,
+// backward shift erase) and recency is a list linked by slot indices, so insert,
+// hit and evict do not touch the heap.
+template<typename KeyType, typename ValueType, size_t CacheSize,
+    typename HashType = std::hash<KeyType>, typename KeyEqualType = std::equal_to<KeyType>>
+class FlatLruCache {
+ private:
+    using IndexType = uint32_t;
+    using EntryType = std::pair<KeyType, ValueType>;
+
+    static_assert(CacheSize > 0 && CacheSize < std::numeric_limits<IndexType>::max() / 2);
+
+    static constexpr IndexType kNullIndex = std::numeric_limits<IndexType>::max();
+    static constexpr size_t kTableSize = std::bit_ceil(CacheSize * 2);
+    static constexpr size_t kTableMask = kTableSize - 1;
+
+    struct Slot {
+        std::optional<EntryType> entry;
+        size_t hash = 0;
+        IndexType prev = kNullIndex;
+        IndexType next = kNullIndex;
+    };
+
+    template<bool kIsConst>
+    class Iterator {
+     private:
+        using SlotPtr = std::conditional_t<kIsConst, const Slot*, Slot*>;
+
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EntryType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<kIsConst, const EntryType*, EntryType*>;
+        using reference = std::conditional_t<kIsConst, const EntryType&, EntryType&>;
+
+     public:
+        Iterator() = default;
+        Iterator(SlotPtr slot, SlotPtr slot_end) : slot_(slot), slot_end_(slot_end) { SkipEmpty(); };
+
+     public:
+        reference operator*() const { return *slot_->entry; };
+        pointer operator->() const { return &*slot_->entry; };
+
+        Iterator& operator++() { ++slot_; SkipEmpty(); return *this; };
+        Iterator operator++(int) { Iterator old = *this; ++(*this); return old; };
+
+        bool operator==(const Iterator& other) const { return slot_ == other.slot_; };
+
+     private:
+        void SkipEmpty() {
+            while (slot_ != slot_end_ && !slot_->entry) {
+                ++slot_;
+            }
+        };
+
+     private:
+        SlotPtr slot_ = nullptr;
+        SlotPtr slot_end_ = nullptr;
+    };
+
+ public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+ public:
+    FlatLruCache() : slots_(CacheSize), table_(kTableSize, kNullIndex) { BuildFreeList(); };
+
+ public:
+    size_t size() const { return size_; };
+
+    bool contains(const KeyType& key) const { return Find(key) != kNullIndex; };
+
+    bool empty() const { return size_ == 0; };
+
+    void clear();
+
+ public:
+    bool insert(const KeyType& key, const ValueType& value);
+    void erase(const KeyType& key);
+    std::optional<ValueType> get(const KeyType& key);
+
+ public:
+    iterator begin() { return {slots_.data(), slots_.data() + slots_.size()}; };
+    const_iterator cbegin() const { return {slots_.data(), slots_.data() + slots_.size()}; };
+    iterator end() { return {slots_.data() + slots_.size(), slots_.data() + slots_.size()}; };
+    const_iterator cend() const { return {slots_.data() + slots_.size(), slots_.data() + slots_.size()}; };
+
+ private:
+    size_t Find(const KeyType& key) const;
+    size_t FindSlotPos(IndexType slot_index) const;
+    void TableErase(size_t table_pos);
+
+    void Unlink(IndexType slot_index);
+    void PushFront(IndexType slot_index);
+    void BuildFreeList();
+    void Release(IndexType slot_index);
+
+    void Kick();
+
+ private:
+    std::vector<Slot> slots_;
+    std::vector<IndexType> table_;
+
+    IndexType head_ = kNullIndex;
+    IndexType tail_ = kNullIndex;
+    IndexType free_head_ = kNullIndex;
+
+    size_t size_ = 0;
+
+    [[no_unique_address]] HashType hasher_;
+    [[no_unique_address]] KeyEqualType key_equal_;
+};
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+size_t FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::Find(const KeyType& key) const {
+    const size_t hash = hasher_(key);
+
+    for (size_t table_pos = hash & kTableMask; table_[table_pos] != kNullIndex; table_pos = (table_pos + 1) & kTableMask) {
+        const Slot& slot = slots_[table_[table_pos]];
+        if (slot.hash == hash && key_equal_(slot.entry->first, key)) {
+            return table_pos;
+        }
+    }
+
+    return kNullIndex;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+size_t FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::FindSlotPos(IndexType slot_index) const {
+    size_t table_pos = slots_[slot_index].hash & kTableMask;
+
+    while (table_[table_pos] != slot_index) {
+        table_pos = (table_pos + 1) & kTableMask;
+    }
+
+    return table_pos;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::TableErase(size_t table_pos) {
+    size_t hole_pos = table_pos;
+
+    for (size_t next_pos = (hole_pos + 1) & kTableMask; table_[next_pos] != kNullIndex; next_pos = (next_pos + 1) & kTableMask) {
+        const size_t home_pos = slots_[table_[next_pos]].hash & kTableMask;
+
+        // shift back only entries whose probe chain passes through the hole
+        if (((next_pos - home_pos) & kTableMask) >= ((next_pos - hole_pos) & kTableMask)) {
+            table_[hole_pos] = table_[next_pos];
+            hole_pos = next_pos;
+        }
+    }
+
+    table_[hole_pos] = kNullIndex;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::Unlink(IndexType slot_index) {
+    Slot& slot = slots_[slot_index];
+
+    if (slot.prev != kNullIndex) {
+        slots_[slot.prev].next = slot.next;
+    } else {
+        head_ = slot.next;
+    }
+
+    if (slot.next != kNullIndex) {
+        slots_[slot.next].prev = slot.prev;
+    } else {
+        tail_ = slot.prev;
+    }
+
+    slot.prev = slot.next = kNullIndex;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::PushFront(IndexType slot_index) {
+    Slot& slot = slots_[slot_index];
+
+    slot.prev = kNullIndex;
+    slot.next = head_;
+
+    if (head_ != kNullIndex) {
+        slots_[head_].prev = slot_index;
+    } else {
+        tail_ = slot_index;
+    }
+
+    head_ = slot_index;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::BuildFreeList() {
+    for (size_t slot_index = 0; slot_index < slots_.size(); ++slot_index) {
+        slots_[slot_index].next = (slot_index + 1 < slots_.size()) ? slot_index + 1 : kNullIndex;
+    }
+
+    free_head_ = 0;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::Release(IndexType slot_index) {
+    TableErase(FindSlotPos(slot_index));
+    Unlink(slot_index);
+
+    slots_[slot_index].entry.reset();
+    slots_[slot_index].next = free_head_;
+    free_head_ = slot_index;
+
+    --size_;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::clear() {
+    for (auto& slot : slots_) {
+        slot.entry.reset();
+        slot.prev = kNullIndex;
+    }
+    std::fill(table_.begin(), table_.end(), kNullIndex);
+
+    head_ = tail_ = kNullIndex;
+    size_ = 0;
+
+    BuildFreeList();
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+bool FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::insert(const KeyType& key, const ValueType& value) {
+    if (Find(key) != kNullIndex) {
+        return false;
+    }
+
+    if (size_ >= CacheSize) {
+        Kick();
+    }
+
+    const IndexType slot_index = free_head_;
+    Slot& slot = slots_[slot_index];
+    free_head_ = slot.next;
+
+    slot.entry.emplace(key, value);
+    slot.hash = hasher_(key);
+
+    size_t table_pos = slot.hash & kTableMask;
+    while (table_[table_pos] != kNullIndex) {
+        table_pos = (table_pos + 1) & kTableMask;
+    }
+    table_[table_pos] = slot_index;
+
+    PushFront(slot_index);
+
+    ++size_;
+    return true;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::Kick() {
+    Release(tail_);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+void FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::erase(const KeyType& key) {
+    if (size_t table_pos = Find(key); table_pos != kNullIndex) {
+        Release(table_[table_pos]);
+    }
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename HashType, typename KeyEqualType>
+std::optional<ValueType> FlatLruCache<KeyType, ValueType, CacheSize, HashType, KeyEqualType>::get(const KeyType& key) {
+    size_t table_pos = Find(key);
+
+    if (table_pos == kNullIndex) {
+        return {};
+    }
+
+    const IndexType slot_index = table_[table_pos];
+
+    if (slot_index != head_) {
+        Unlink(slot_index);
+        PushFront(slot_index);
+    }
+
+    return slots_[slot_index].entry->second;
+}
+
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _FLAT_LRU_CACHE_HPP_
@@ -1,36 +1,110 @@
 #ifndef _LRU_CACHE_HPP_
 #define _LRU_CACHE_HPP_
 
+#include <chrono>
 #include <cstddef>
+#include <ctime>
 #include <unordered_map>
-#include <list>
+#include <memory>
 #include <optional>
 #include <utility>
 
+#include "cache_policy.hpp"
+#include "timer_wheel.hpp"
+
 namespace waybuilder {
 
 namespace __detail {
 
-template<typename KeyType, typename ValueType, size_t CacheSize,
-    typename CacheContType = std::unordered_map<KeyType, std::pair<ValueType, typename std::list<KeyType>::iterator>>>
+template<typename ValueType>
+struct UnitWeigher {
+    size_t operator()(const ValueType&) const { return 1; };
+};
+
+
+template<typename ValueType, typename PolicyHandleType>
+struct LruCacheEntry {
+    std::shared_ptr<const ValueType> value;
+    PolicyHandleType policy_handle;
+    size_t weight;
+    std::time_t expire_time = 0;
+    size_t hit_count = 0;
+};
+
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t expirations = 0;
+};
+
+
+// Capacity is counted in WeigherType units: entries by default, or any other
+// measure (e.g. bytes) the weigher returns for a value. CacheSize is the
+// default capacity, it can be changed at runtime.
+// Entries inserted with a ttl expire lazily on access and are reaped by a
+// timer wheel on every insert/get, entries without ttl never expire.
+// Values are stored behind shared immutable handles: get_handle() shares the
+// stored value in O(1), get() returns a copy.
+// PolicyType picks the entry to evict (see cache_policy.hpp), LRU by default.
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType = UnitWeigher<ValueType>,
+    typename PolicyType = LruPolicy<KeyType>,
+    typename CacheContType = std::unordered_map<KeyType, LruCacheEntry<ValueType, typename PolicyType::Handle>>>
 class LruCache {
  private:
-    using ListType = std::list<KeyType>;
+    using EntryType = LruCacheEntry<ValueType, typename PolicyType::Handle>;
     using iterator = CacheContType::iterator;
     using const_iterator = CacheContType::const_iterator;
+ public:
+    using ValueHandle = std::shared_ptr<const ValueType>;
+
+ public:
+    LruCache() { policy_.SetCapacity(capacity_); };
+    explicit LruCache(size_t capacity, WeigherType weigher = {}) : capacity_(capacity), weigher_(weigher) {
+        policy_.SetCapacity(capacity_);
+    };
+
  public:
     size_t size() const { return size_; };
 
-    bool contains(const KeyType& key) const { return cont_.contains(key); };
+    bool contains(const KeyType& key) const {
+        auto cont_itr = cont_.find(key);
+        return cont_itr != cont_.end() && !IsExpired(cont_itr->second);
+    };
+
+    bool empty() const { return size_ == 0; };
 
-    bool empty() const { return size_; };
+    // hits of the key since it was inserted, 0 for absent keys
+    size_t hit_count(const KeyType& key) const {
+        auto cont_itr = cont_.find(key);
+        return cont_itr != cont_.end() ? cont_itr->second.hit_count : 0;
+    };
 
-    void clear() { list_.clear(); cont_.clear(); };
+    void clear() { policy_.clear(); cont_.clear(); timer_wheel_.clear(); size_ = 0; weight_ = 0; };
 
  public:
-    bool insert(const KeyType& key, const ValueType& value);
+    size_t weight() const { return weight_; };
+    size_t capacity() const { return capacity_; };
+    void set_capacity(size_t capacity);
+
+ public:
+    const CacheStats& stats() const { return stats_; };
+    void reset_stats() { stats_ = {}; };
+
+ public:
+    bool insert(const KeyType& key, const ValueType& value, std::time_t ttl = 0);
+    bool insert(const KeyType& key, ValueType&& value, std::time_t ttl = 0);
+    bool insert(const KeyType& key, ValueHandle value, std::time_t ttl = 0);
+
+    template<typename... ArgsT>
+    bool emplace(const KeyType& key, std::time_t ttl, ArgsT&&... args);
+
     void erase(const KeyType& key);
     std::optional<ValueType> get(const KeyType& key);
+    ValueHandle get_handle(const KeyType& key);
+
+    void reap_expired();
 
  public:
     iterator begin() { return cont_.begin(); };
@@ -40,75 +114,189 @@ class LruCache {
 
  private:
     void Kick();
+    void Erase(iterator cont_itr);
+    void Remove(iterator cont_itr);
+    bool IsExpired(const EntryType& entry) const;
+
+    static std::time_t Now() { return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()); };
 
  private:
-    ListType list_;
     CacheContType cont_;
+    PolicyType policy_;
+    TimerWheel<KeyType> timer_wheel_{Now()};
     size_t size_ = 0;
+    size_t weight_ = 0;
+    size_t capacity_ = CacheSize;
+    CacheStats stats_;
+    [[no_unique_address]] WeigherType weigher_;
 };
 
 
-template<typename KeyType, typename ValueType, size_t CacheSize, typename CacheContType>
-bool LruCache<KeyType, ValueType, CacheSize, CacheContType>::insert(const KeyType& key, const ValueType& value) {
-    if (cont_.find(key) != cont_.end()) {
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+bool LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::insert(const KeyType& key, const ValueType& value, std::time_t ttl) {
+    return insert(key, std::make_shared<const ValueType>(value), ttl);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+bool LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::insert(const KeyType& key, ValueType&& value, std::time_t ttl) {
+    return insert(key, std::make_shared<const ValueType>(std::move(value)), ttl);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+template<typename... ArgsT>
+bool LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::emplace(const KeyType& key, std::time_t ttl, ArgsT&&... args) {
+    if (contains(key)) {
         return false;
     }
 
-    if (size_ >= CacheSize) {
+    return insert(key, std::make_shared<const ValueType>(std::forward<ArgsT>(args)...), ttl);
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+bool LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::insert(const KeyType& key, ValueHandle value, std::time_t ttl) {
+    if (!value) {
+        return false;
+    }
+
+    reap_expired();
+
+    if (auto cont_itr = cont_.find(key); cont_itr != cont_.end()) {
+        if (!IsExpired(cont_itr->second)) {
+            return false;
+        }
+        Erase(cont_itr);
+        ++stats_.expirations;
+    }
+
+    const size_t value_weight = weigher_(*value);
+
+    if (value_weight > capacity_) {
+        return false;
+    }
+
+    while (size_ && weight_ + value_weight > capacity_) {
         Kick();
     }
 
-    list_.push_front(key);
-    cont_.insert({key, std::make_pair(value, list_.begin())});
+    const std::time_t expire_time = ttl > 0 ? Now() + ttl : 0;
+
+    auto policy_handle = policy_.Insert(key, value_weight);
+    cont_.insert({key, EntryType{std::move(value), policy_handle, value_weight, expire_time}});
+
+    if (expire_time) {
+        timer_wheel_.Schedule(key, expire_time);
+    }
     
     ++size_;
+    weight_ += value_weight;
     return true;
 }
 
 
-template<typename KeyType, typename ValueType, size_t CacheSize, typename CacheContType>
-void LruCache<KeyType, ValueType, CacheSize, CacheContType>::Kick() {
-    auto kicked_itr = --list_.end();
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::set_capacity(size_t capacity) {
+    capacity_ = capacity;
+    policy_.SetCapacity(capacity_);
+
+    while (size_ && weight_ > capacity_) {
+        Kick();
+    }
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::Kick() {
+    auto cont_itr = cont_.find(policy_.Victim());
+
+    policy_.Evict(cont_itr->second.policy_handle);
+    Remove(cont_itr);
+
+    ++stats_.evictions;
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::erase(const KeyType& key) {
+    if (auto cont_itr = cont_.find(key); cont_itr != cont_.end()) {
+        Erase(cont_itr);
+    }
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::Erase(iterator cont_itr) {
+    policy_.Erase(cont_itr->second.policy_handle);
+    Remove(cont_itr);
+}
 
-    cont_.erase(*kicked_itr);
-    list_.pop_back();
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::Remove(iterator cont_itr) {
+    weight_ -= cont_itr->second.weight;
+    cont_.erase(cont_itr);
     --size_;
 }
 
 
-template<typename KeyType, typename ValueType, size_t CacheSize, typename CacheContType>
-void LruCache<KeyType, ValueType, CacheSize, CacheContType>::erase(const KeyType& key) {
-    if (cont_.contains(key)) {
-        auto& list_itr = cont_.at(key).second;
-        list_.erase(list_itr);
-        cont_.erase(key);
-        --size_;
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+bool LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::IsExpired(const EntryType& entry) const {
+    return entry.expire_time && entry.expire_time <= Now();
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+void LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::reap_expired() {
+    if (timer_wheel_.empty()) {
+        return;
     }
+
+    timer_wheel_.Advance(Now(), [this](const KeyType& key, std::time_t expire_time) {
+        // timers of erased or reinserted entries are stale, skip them
+        if (auto cont_itr = cont_.find(key); cont_itr != cont_.end() && cont_itr->second.expire_time == expire_time) {
+            Erase(cont_itr);
+            ++stats_.expirations;
+        }
+    });
 }
 
 
-template<typename KeyType, typename ValueType, size_t CacheSize, typename CacheContType>
-std::optional<ValueType> LruCache<KeyType, ValueType, CacheSize, CacheContType>::get(const KeyType& key) {
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+std::optional<ValueType> LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::get(const KeyType& key) {
+    if (auto value = get_handle(key); value) {
+        return *value;
+    }
+
+    return {};
+}
+
+
+template<typename KeyType, typename ValueType, size_t CacheSize, typename WeigherType, typename PolicyType, typename CacheContType>
+auto LruCache<KeyType, ValueType, CacheSize, WeigherType, PolicyType, CacheContType>::get_handle(const KeyType& key) -> ValueHandle {
+    reap_expired();
+    policy_.Record(key);
+
     auto cont_itr = cont_.find(key);
 
     if (cont_itr == cont_.end()) {
+        ++stats_.misses;
         return {};
     }
 
-    auto value_itr = cont_itr->second.second;
-
-    if(value_itr != list_.begin()) {
-        list_.erase(value_itr);
-        list_.push_front(key);
-
-        const ValueType& value = cont_itr->second.first;
+    if (IsExpired(cont_itr->second)) {
+        Erase(cont_itr);
+        ++stats_.expirations;
+        ++stats_.misses;
+        return {};
+    }
 
-        cont_.insert({key, std::make_pair(value, list_.begin())});
+    policy_.Access(cont_itr->second.policy_handle);
+    ++cont_itr->second.hit_count;
+    ++stats_.hits;
 
-        return value;
-    } else {
-        return cont_itr->second.first;
-    }
+    return cont_itr->second.value;
 }
 
 
@@ -0,0 +1,162 @@
+#ifndef _TIMER_WHEEL_HPP_
+#define _TIMER_WHEEL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ctime>
+#include <utility>
+#include <vector>
+
+namespace waybuilder {
+
+namespace __detail {
+
+// Hierarchical timer wheel with one second ticks: kLevelCount levels of
+// kSlotCount slots, level n covers delays up to kSlotCount^(n + 1) seconds.
+// Timers of upper levels are cascaded down when the lower level wraps, so
+// advancing the clock costs O(ticks + expired) and never scans all timers.
+// Timers can not be cancelled, the owner must check on expiry that the key
+// still carries the same expire time.
+template<typename KeyType>
+class TimerWheel {
+ private:
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlotCount = 1 << kSlotBits;
+    static constexpr size_t kSlotMask = kSlotCount - 1;
+    static constexpr size_t kLevelCount = 4;
+    static constexpr std::time_t kMaxDelay = (std::time_t{1} << (kSlotBits * kLevelCount)) - 1;
+
+    struct Timer {
+        KeyType key;
+        std::time_t expire_time;
+    };
+
+    using SlotType = std::vector<Timer>;
+    using LevelType = std::array<SlotType, kSlotCount>;
+
+ public:
+    explicit TimerWheel(std::time_t current_time = 0) : current_time_(current_time) {  };
+
+ public:
+    size_t size() const { return size_; };
+
+    bool empty() const { return size_ == 0; };
+
+    void clear();
+
+ public:
+    void Schedule(const KeyType& key, std::time_t expire_time);
+
+    template<typename ExpireFuncType>
+    void Advance(std::time_t current_time, ExpireFuncType&& on_expire);
+
+ private:
+    void Place(Timer&& timer);
+    bool Cascade(size_t level);
+
+ private:
+    std::array<LevelType, kLevelCount> levels_;
+    std::time_t current_time_;
+    size_t size_ = 0;
+};
+
+
+template<typename KeyType>
+void TimerWheel<KeyType>::clear() {
+    for (auto& level : levels_) {
+        for (auto& slot : level) {
+            slot.clear();
+        }
+    }
+
+    size_ = 0;
+}
+
+
+template<typename KeyType>
+void TimerWheel<KeyType>::Schedule(const KeyType& key, std::time_t expire_time) {
+    Place(Timer{key, expire_time});
+    ++size_;
+}
+
+
+template<typename KeyType>
+void TimerWheel<KeyType>::Place(Timer&& timer) {
+    const std::time_t delay = timer.expire_time - current_time_;
+
+    if (delay < 0) {
+        levels_[0][current_time_ & kSlotMask].push_back(std::move(timer));
+        return;
+    }
+
+    // timers further than the wheel range park in the top level and are
+    // placed again when they are cascaded
+    const std::time_t slot_time = (delay > kMaxDelay) ? current_time_ + kMaxDelay : timer.expire_time;
+
+    size_t level = 0;
+    while (level + 1 < kLevelCount && delay >= (std::time_t{1} << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+
+    levels_[level][(slot_time >> (kSlotBits * level)) & kSlotMask].push_back(std::move(timer));
+}
+
+
+template<typename KeyType>
+bool TimerWheel<KeyType>::Cascade(size_t level) {
+    const size_t slot_index = (current_time_ >> (kSlotBits * level)) & kSlotMask;
+
+    SlotType slot = std::move(levels_[level][slot_index]);
+    levels_[level][slot_index].clear();
+
+    for (auto& timer : slot) {
+        Place(std::move(timer));
+    }
+
+    return slot_index == 0;
+}
+
+
+template<typename KeyType>
+template<typename ExpireFuncType>
+void TimerWheel<KeyType>::Advance(std::time_t current_time, ExpireFuncType&& on_expire) {
+    if (size_ == 0) {
+        current_time_ = std::max(current_time_, current_time + 1);
+        return;
+    }
+
+    while (current_time_ <= current_time && size_) {
+        const size_t slot_index = current_time_ & kSlotMask;
+
+        if (slot_index == 0) {
+            for (size_t level = 1; level < kLevelCount && Cascade(level); ++level) {
+            }
+        }
+
+        SlotType slot = std::move(levels_[0][slot_index]);
+        levels_[0][slot_index].clear();
+
+        for (auto& timer : slot) {
+            if (timer.expire_time <= current_time_) {
+                --size_;
+                on_expire(timer.key, timer.expire_time);
+            } else {
+                Place(std::move(timer));
+            }
+        }
+
+        ++current_time_;
+    }
+
+    if (size_ == 0) {
+        current_time_ = std::max(current_time_, current_time + 1);
+    }
+}
+
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _TIMER_WHEEL_HPP_
@@ -0,0 +1,354 @@
+#ifndef _WAY_CACHE_HPP_
+#define _WAY_CACHE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <lru_cache.hpp>
+
+#include "way_disk_cache.hpp"
+#include "way_cache_key.hpp"
+#include "way_refresher.hpp"
+#include "way_query_predictor.hpp"
+#include "way_schedule_template.hpp"
+#include "way_single_flight.hpp"
+
+namespace waybuilder {
+
+namespace __detail {
+
+// Two level way cache: in-memory MemCacheType in front of the on-disk journal.
+// Disk hits are promoted back into memory, entries expire lifetime seconds
+// after their stamp in both levels. Values are handed out as shared
+// immutable handles, a memory hit does not copy the ways json.
+// Failed searches are kept apart in a small memory-only negative cache with
+// a short ttl per outcome, so repeats are answered without the api.
+// Stale-while-revalidate: entries stay cached for a grace period after their
+// lifetime, stale or hot nearly expired entries are still served and the
+// owner schedules their refresh on the background WayRefresher. Uncached
+// keys are prefetched the same way, fetched values land on the next lookup.
+// Speculative prefetch: WayQueryPredictor guesses the next queries from the
+// query history, their prefetches are capped by a per run budget and counted
+// as hits when a later lookup finds them.
+// Schedule templates of point pairs live in a memory-only cache for the
+// ways lifetime, they answer dated searches of the pair without the api.
+// Searches of a key run through WaySingleFlight, concurrent identical ones
+// share one api request and one parsed result.
+template<typename MemCacheType>
+class WayCache {
+ public:
+    enum class MissReason { NO_WAYS, CLIENT_ERROR };
+
+    struct NegativeEntry {
+        MissReason reason;
+        long status_code;
+    };
+
+    static constexpr size_t kNegativeCacheSize = 1024;
+    static constexpr std::time_t kNoWaysLifetime = 30 * 60;
+    static constexpr std::time_t kClientErrorLifetime = 5 * 60;
+
+    // definitive answers only, throttling and timeouts pass with a retry
+    static bool IsCacheableClientError(long status_code) { return status_code == 400 || status_code == 404; };
+
+    static constexpr std::time_t kRefreshAhead = 10 * 60;
+    static constexpr size_t kHotHitCount = 3;
+
+    static constexpr size_t kMaxPredictions = 2;
+    static constexpr size_t kTemplateCacheSize = 256;
+
+    using FetchFuncType = WayRefresher::FetchFuncType;
+    using SearchResultType = WaySingleFlight::ResultType;
+    using SearchFuncType = WaySingleFlight::FetchFuncType;
+
+    struct SpeculationStats {
+        size_t prefetches = 0;
+        size_t hits = 0;
+    };
+
+ public:
+    using KeyType = WayCacheKey;
+    using ValueType = std::pair<nlohmann::json, std::time_t>;
+    using ValueHandle = std::shared_ptr<const ValueType>;
+    using QueryType = WayQuery;
+    using TemplateType = WayScheduleTemplate;
+    using TemplateHandle = std::shared_ptr<const TemplateType>;
+    using iterator = decltype(std::declval<MemCacheType&>().begin());
+    using const_iterator = decltype(std::declval<const MemCacheType&>().cbegin());
+
+ public:
+    template<typename... MemCacheArgs>
+    WayCache(const std::string& cache_dir_path, std::time_t lifetime, std::time_t grace, size_t speculation_budget,
+        MemCacheArgs&&... mem_cache_args)
+        : mem_cache_{std::forward<MemCacheArgs>(mem_cache_args)...}, disk_cache_{cache_dir_path, lifetime + grace},
+            predictor_{cache_dir_path}, lifetime_{lifetime}, grace_{grace}, speculation_budget_{speculation_budget} {  };
+
+ public:
+    size_t size() const { return mem_cache_.size(); };
+
+    bool contains(const KeyType& key) const { return mem_cache_.contains(key); };
+
+    void clear() { mem_cache_.clear(); negative_cache_.clear(); template_cache_.clear(); };
+
+    size_t weight() const { return mem_cache_.weight(); };
+
+    size_t capacity() const { return mem_cache_.capacity(); };
+
+    const CacheStats& stats() const { return mem_cache_.stats(); };
+
+    const CacheStats& negative_stats() const { return negative_cache_.stats(); };
+
+    const CacheStats& template_stats() const { return template_cache_.stats(); };
+
+    size_t refresh_count() const { return refresh_count_; };
+
+    const SpeculationStats& speculation_stats() const { return speculation_stats_; };
+
+    size_t coalesced_count() const { return single_flight_.GetCoalescedCount(); };
+
+ public:
+    bool insert(const KeyType& key, const ValueType& value);
+    bool insert(const KeyType& key, ValueHandle value);
+    void erase(const KeyType& key);
+    ValueHandle get(const KeyType& key);
+
+    // stale entries, and hot entries close to the end of their lifetime
+    bool NeedsRefresh(const KeyType& key, const ValueType& value) const;
+    bool ScheduleRefresh(const KeyType& key, FetchFuncType fetch) { return refresher_.Schedule(key, std::move(fetch)); };
+    // false if the key is cached and fresh or already scheduled
+    bool SchedulePrefetch(const KeyType& key, FetchFuncType fetch);
+    // prefetch of a predicted query, false once the budget is spent
+    bool ScheduleSpeculation(const KeyType& key, FetchFuncType fetch);
+
+    // thread safe, joins the search of the key if one is in flight
+    SearchResultType Search(const KeyType& key, const SearchFuncType& search) { return single_flight_.Do(key, search); };
+
+    void ObserveQuery(const QueryType& query) { predictor_.Observe(query); };
+    std::vector<QueryType> PredictQueries(const QueryType& query) const { return predictor_.Predict(query, kMaxPredictions); };
+    // pairs asked before, with this date or another one
+    bool IsPairSeen(const QueryType& query) const { return predictor_.HasPair(query.from_point, query.to_point); };
+
+    // false for client errors that are not cacheable
+    bool InsertNegative(const KeyType& key, MissReason reason, long status_code = 0);
+    std::optional<NegativeEntry> GetNegative(const KeyType& key) { return negative_cache_.get(key); };
+
+    // pair keys have no day, invalid templates are kept to skip their pairs
+    TemplateHandle GetTemplate(const KeyType& pair_key) { return template_cache_.get_handle(pair_key); };
+    TemplateHandle InsertTemplate(const KeyType& pair_key, TemplateType schedule_template);
+    // single flight key of the template search of the pair
+    static KeyType MakeTemplateKey(const KeyType& pair_key) { return WayCacheKeyFactory::MakeDaysMaskKey(pair_key); };
+
+ public:
+    std::optional<KeyType> MakeKey(std::string_view from_point, std::string_view to_point, std::string_view date,
+        std::string_view lang, bool transfers = false, std::string_view transport_types = "") {
+        return key_factory_.MakeKey(from_point, to_point, date, lang, transfers, transport_types);
+    };
+
+ public:
+    iterator begin() { return mem_cache_.begin(); };
+    const_iterator cbegin() const { return mem_cache_.cbegin(); };
+    iterator end() { return mem_cache_.end(); };
+    const_iterator cend() const { return mem_cache_.cend(); };
+
+ public:
+    MemCacheType& GetMemCacheRef() { return mem_cache_; };
+    WayDiskCache& GetDiskCacheRef() { return disk_cache_; };
+    WayQueryPredictor& GetPredictorRef() { return predictor_; };
+
+ private:
+    static std::time_t Now() { return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()); };
+
+    // time left in the cache, grace period included
+    std::time_t RemainingLifetime(std::time_t stamp) const { return lifetime_ + grace_ - (Now() - stamp); };
+
+    void ApplyRefreshes();
+
+    void CountSpeculation(const KeyType& key, bool is_hit);
+
+ private:
+    MemCacheType mem_cache_;
+    LruCache<KeyType, NegativeEntry, kNegativeCacheSize> negative_cache_;
+    LruCache<KeyType, TemplateType, kTemplateCacheSize> template_cache_;
+    WayDiskCache disk_cache_;
+    WayCacheKeyFactory key_factory_;
+    WayQueryPredictor predictor_;
+    std::time_t lifetime_;
+    std::time_t grace_;
+    size_t refresh_count_ = 0;
+
+    std::unordered_set<KeyType> speculated_keys_;
+    SpeculationStats speculation_stats_;
+    size_t speculation_budget_;
+
+    WaySingleFlight single_flight_;
+
+    // last member, the worker stops before the caches are destroyed
+    WayRefresher refresher_;
+};
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::insert(const KeyType& key, const ValueType& value) {
+    return insert(key, std::make_shared<const ValueType>(value));
+}
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::insert(const KeyType& key, ValueHandle value) {
+    if (!value) {
+        return false;
+    }
+
+    const std::time_t ttl = RemainingLifetime(value->second);
+
+    // the handle stays alive for the disk write even if memory evicts it
+    const ValueHandle stored_value = value;
+
+    if (ttl <= 0) {
+        return false;
+    }
+
+    // a value over the memory budget is still served from the disk
+    const bool is_in_memory = mem_cache_.insert(key, std::move(value), ttl);
+    const bool is_on_disk = disk_cache_.Insert(key_factory_.ToString(key), *stored_value);
+
+    if (!is_in_memory && !is_on_disk) {
+        return false;
+    }
+
+    negative_cache_.erase(key);
+    return true;
+}
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::NeedsRefresh(const KeyType& key, const ValueType& value) const {
+    const std::time_t age = Now() - value.second;
+
+    if (age >= lifetime_) {
+        return true;
+    }
+
+    return age >= lifetime_ - kRefreshAhead && mem_cache_.hit_count(key) >= kHotHitCount;
+}
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::SchedulePrefetch(const KeyType& key, FetchFuncType fetch) {
+    // every cached value is journaled, the disk index knows all stamps
+    if (auto stamp = disk_cache_.GetStamp(key_factory_.ToString(key)); stamp && Now() - *stamp < lifetime_ - kRefreshAhead) {
+        return false;
+    }
+
+    return ScheduleRefresh(key, std::move(fetch));
+}
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::ScheduleSpeculation(const KeyType& key, FetchFuncType fetch) {
+    if (speculation_stats_.prefetches >= speculation_budget_ || negative_cache_.contains(key)) {
+        return false;
+    }
+
+    if (!SchedulePrefetch(key, std::move(fetch))) {
+        return false;
+    }
+
+    speculated_keys_.insert(key);
+    ++speculation_stats_.prefetches;
+
+    return true;
+}
+
+
+template<typename MemCacheType>
+void WayCache<MemCacheType>::CountSpeculation(const KeyType& key, bool is_hit) {
+    // first lookup of a speculated key decides, a late prefetch is a miss
+    if (speculated_keys_.erase(key) && is_hit) {
+        ++speculation_stats_.hits;
+    }
+}
+
+
+template<typename MemCacheType>
+void WayCache<MemCacheType>::ApplyRefreshes() {
+    for (auto& [key, value] : refresher_.TakeResults()) {
+        // refreshed value replaces the stale one in both levels
+        mem_cache_.erase(key);
+
+        if (insert(key, std::move(value))) {
+            ++refresh_count_;
+        }
+    }
+}
+
+
+template<typename MemCacheType>
+bool WayCache<MemCacheType>::InsertNegative(const KeyType& key, MissReason reason, long status_code) {
+    if (reason == MissReason::CLIENT_ERROR && !IsCacheableClientError(status_code)) {
+        return false;
+    }
+
+    const std::time_t ttl = (reason == MissReason::NO_WAYS) ? kNoWaysLifetime : kClientErrorLifetime;
+
+    negative_cache_.erase(key);
+    return negative_cache_.insert(key, NegativeEntry{reason, status_code}, ttl);
+}
+
+
+template<typename MemCacheType>
+auto WayCache<MemCacheType>::InsertTemplate(const KeyType& pair_key, TemplateType schedule_template) -> TemplateHandle {
+    TemplateHandle handle = std::make_shared<const TemplateType>(std::move(schedule_template));
+
+    template_cache_.erase(pair_key);
+    template_cache_.insert(pair_key, handle, lifetime_);
+
+    return handle;
+}
+
+
+template<typename MemCacheType>
+void WayCache<MemCacheType>::erase(const KeyType& key) {
+    mem_cache_.erase(key);
+    negative_cache_.erase(key);
+    disk_cache_.Erase(key_factory_.ToString(key));
+}
+
+
+template<typename MemCacheType>
+auto WayCache<MemCacheType>::get(const KeyType& key) -> ValueHandle {
+    ApplyRefreshes();
+
+    if (auto mem_value = mem_cache_.get_handle(key); mem_value) {
+        CountSpeculation(key, true);
+        return mem_value;
+    }
+
+    auto disk_value = disk_cache_.Get(key_factory_.ToString(key));
+    CountSpeculation(key, static_cast<bool>(disk_value));
+
+    if (!disk_value) {
+        return {};
+    }
+
+    ValueHandle value = std::make_shared<const ValueType>(std::move(*disk_value));
+    mem_cache_.insert(key, value, RemainingLifetime(value->second));
+
+    return value;
+}
+
+} // namespace __detail
+
+} // namespace waybuilder
+
+#endif // _WAY_CACHE_HPP_
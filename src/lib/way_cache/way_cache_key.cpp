@@ -0,0 +1,178 @@
+#include "way_cache_key.hpp"
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace waybuilder {
+
+namespace {
+
+// bit order of WayCacheKey::flags, values of api "transport_types" argument
+constexpr std::array<std::string_view, 6> kTransportTypes = {
+    "plane", "train", "suburban", "bus", "water", "helicopter"
+};
+
+constexpr uint64_t Mix(uint64_t value) {
+    // splitmix64 finalizer
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    return value;
+}
+
+} // namespace
+
+
+WayCacheKeyFactory::WayCacheKeyFactory() {
+    // id 0 is the empty code
+    Intern("");
+}
+
+
+std::optional<WayCacheKey> WayCacheKeyFactory::MakeKey(std::string_view from_point, std::string_view to_point,
+    std::string_view date, std::string_view lang, bool transfers, std::string_view transport_types) {
+    auto day = ParseDay(date);
+    auto transport_flags = ParseTransportTypes(transport_types);
+
+    if (!day || !transport_flags) {
+        return {};
+    }
+
+    WayCacheKey key;
+    key.from_point = Intern(from_point);
+    key.to_point = Intern(to_point);
+    key.day = *day;
+    key.lang = Intern(lang);
+    key.flags = *transport_flags | (transfers ? WayCacheKey::kTransfersFlag : 0);
+    key.hash = Hash(key);
+
+    return key;
+}
+
+
+WayCacheKey WayCacheKeyFactory::MakeDaysMaskKey(WayCacheKey pair_key) {
+    pair_key.flags |= WayCacheKey::kDaysMaskFlag;
+    pair_key.hash = Hash(pair_key);
+
+    return pair_key;
+}
+
+
+std::string WayCacheKeyFactory::ToString(const WayCacheKey& key) const {
+    std::stringstream key_stream;
+
+    key_stream << GetCode(key.from_point) << '|' << GetCode(key.to_point) << '|';
+
+    key_stream << FormatDay(key.day) << '|' << GetCode(key.lang) << '|' << std::hex << key.flags;
+
+    return key_stream.str();
+}
+
+
+std::string WayCacheKeyFactory::FormatDay(int32_t day) {
+    if (day == WayCacheKey::kAnyDay) {
+        return "";
+    }
+
+    std::chrono::year_month_day date{std::chrono::sys_days{std::chrono::days{day}}};
+    std::stringstream date_stream;
+
+    date_stream << std::setfill('0')
+        << std::setw(4) << static_cast<int>(date.year()) << '-'
+        << std::setw(2) << static_cast<unsigned>(date.month()) << '-'
+        << std::setw(2) << static_cast<unsigned>(date.day());
+
+    return date_stream.str();
+}
+
+
+uint32_t WayCacheKeyFactory::Intern(std::string_view code) {
+    // heterogeneous find, known codes are looked up without allocation
+    if (auto code_itr = code_ids_.find(code); code_itr != code_ids_.end()) {
+        return code_itr->second;
+    }
+
+    const uint32_t code_id = codes_.size();
+    codes_.emplace_back(code);
+    code_ids_.emplace(codes_.back(), code_id);
+
+    return code_id;
+}
+
+
+std::optional<int32_t> WayCacheKeyFactory::ParseDay(std::string_view date) {
+    if (date.empty()) {
+        return WayCacheKey::kAnyDay;
+    }
+
+    // yyyy-mm-dd
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') {
+        return {};
+    }
+
+    int year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+
+    auto parse_field = [&date](size_t pos, size_t len, auto& field) {
+        auto [ptr, ec] = std::from_chars(date.data() + pos, date.data() + pos + len, field);
+        return ec == std::errc{} && ptr == date.data() + pos + len;
+    };
+
+    if (!parse_field(0, 4, year) || !parse_field(5, 2, month) || !parse_field(8, 2, day)) {
+        return {};
+    }
+
+    std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{month}, std::chrono::day{day}};
+
+    if (!ymd.ok()) {
+        return {};
+    }
+
+    return std::chrono::sys_days{ymd}.time_since_epoch().count();
+}
+
+
+std::optional<uint32_t> WayCacheKeyFactory::ParseTransportTypes(std::string_view transport_types) {
+    uint32_t transport_flags = 0;
+
+    while (!transport_types.empty()) {
+        size_t delim_pos = transport_types.find(',');
+        std::string_view transport_type = transport_types.substr(0, delim_pos);
+
+        size_t type_index = 0;
+        while (type_index < kTransportTypes.size() && kTransportTypes[type_index] != transport_type) {
+            ++type_index;
+        }
+
+        if (type_index == kTransportTypes.size()) {
+            return {};
+        }
+
+        transport_flags |= 1u << type_index;
+        transport_types.remove_prefix(delim_pos == std::string_view::npos ? transport_types.size() : delim_pos + 1);
+    }
+
+    return transport_flags;
+}
+
+
+size_t WayCacheKeyFactory::Hash(const WayCacheKey& key) {
+    const uint64_t points = (static_cast<uint64_t>(key.from_point) << 32) | key.to_point;
+    const uint64_t query = (static_cast<uint64_t>(static_cast<uint32_t>(key.day)) << 32) | key.lang;
+
+    return Mix(Mix(Mix(points) ^ query) ^ key.flags);
+}
+
+} // namespace waybuilder
@@ -0,0 +1,83 @@
+#ifndef _WAY_CACHE_KEY_HPP_
+#define _WAY_CACHE_KEY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace waybuilder {
+
+// Fixed size key of a way search: interned point codes and language,
+// date as a day number and query flags. The hash is computed once.
+struct WayCacheKey {
+    static constexpr int32_t kAnyDay = std::numeric_limits<int32_t>::min();
+    static constexpr uint32_t kTransfersFlag = 1u << 31;
+    // search of the schedule with days masks instead of the ways of a date
+    static constexpr uint32_t kDaysMaskFlag = 1u << 30;
+
+    uint32_t from_point = 0;
+    uint32_t to_point = 0;
+    int32_t day = kAnyDay;
+    uint32_t lang = 0;
+    uint32_t flags = 0;
+    size_t hash = 0;
+
+    bool operator==(const WayCacheKey& other) const = default;
+};
+
+
+class WayCacheKeyFactory {
+ public:
+    WayCacheKeyFactory();
+
+ public:
+    // nullopt for a malformed date or unknown transport type
+    std::optional<WayCacheKey> MakeKey(std::string_view from_point, std::string_view to_point, std::string_view date,
+        std::string_view lang, bool transfers = false, std::string_view transport_types = "");
+
+    // key of the days masks search of a pair, apart from the plain search of the pair
+    static WayCacheKey MakeDaysMaskKey(WayCacheKey pair_key);
+
+    // canonical textual form, stable between runs
+    std::string ToString(const WayCacheKey& key) const;
+
+ public:
+    const std::string& GetCode(uint32_t code_id) const { return codes_[code_id]; };
+
+ public:
+    // yyyy-mm-dd <-> days since epoch, empty date is kAnyDay
+    static std::optional<int32_t> ParseDay(std::string_view date);
+    static std::string FormatDay(int32_t day);
+
+ private:
+    uint32_t Intern(std::string_view code);
+
+    static std::optional<uint32_t> ParseTransportTypes(std::string_view transport_types);
+    static size_t Hash(const WayCacheKey& key);
+
+ private:
+    struct CodeHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view code) const { return std::hash<std::string_view>{}(code); };
+    };
+
+ private:
+    std::unordered_map<std::string, uint32_t, CodeHash, std::equal_to<>> code_ids_;
+    std::vector<std::string> codes_;
+};
+
+} // namespace waybuilder
+
+
+template<>
+struct std::hash<waybuilder::WayCacheKey> {
+    size_t operator()(const waybuilder::WayCacheKey& key) const noexcept { return key.hash; };
+};
+
+#endif // _WAY_CACHE_KEY_HPP_
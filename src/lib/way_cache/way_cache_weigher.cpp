@@ -0,0 +1,65 @@
+#include "way_cache_weigher.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+namespace {
+
+// red-black tree node header of std::map
+constexpr size_t kMapNodeOverhead = 4 * sizeof(void*);
+
+size_t StringHeapSize(const std::string& str) {
+    // short strings live inside the object itself
+    return str.capacity() > std::string{}.capacity() ? str.capacity() + 1 : 0;
+}
+
+size_t JsonHeapSize(const nlohmann::json& json) {
+    size_t heap_size = 0;
+
+    switch (json.type()) {
+        case nlohmann::json::value_t::object: {
+            const auto& object = json.get_ref<const nlohmann::json::object_t&>();
+            heap_size += sizeof(object);
+            for (const auto& [key, value] : object) {
+                heap_size += kMapNodeOverhead + sizeof(key) + sizeof(value);
+                heap_size += StringHeapSize(key) + JsonHeapSize(value);
+            }
+            break;
+        }
+        case nlohmann::json::value_t::array: {
+            const auto& array = json.get_ref<const nlohmann::json::array_t&>();
+            heap_size += sizeof(array) + array.capacity() * sizeof(nlohmann::json);
+            for (const auto& value : array) {
+                heap_size += JsonHeapSize(value);
+            }
+            break;
+        }
+        case nlohmann::json::value_t::string: {
+            const auto& str = json.get_ref<const nlohmann::json::string_t&>();
+            heap_size += sizeof(str) + StringHeapSize(str);
+            break;
+        }
+        case nlohmann::json::value_t::binary: {
+            const auto& binary = json.get_ref<const nlohmann::json::binary_t&>();
+            heap_size += sizeof(binary) + binary.capacity();
+            break;
+        }
+        default:
+            break;
+    }
+
+    return heap_size;
+}
+
+} // namespace
+
+
+size_t JsonByteSize(const nlohmann::json& json) {
+    return sizeof(json) + JsonHeapSize(json);
+}
+
+} // namespace waybuilder
@@ -0,0 +1,24 @@
+#ifndef _WAY_CACHE_WEIGHER_HPP_
+#define _WAY_CACHE_WEIGHER_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+// Approximate heap footprint of a parsed json document, in bytes
+size_t JsonByteSize(const nlohmann::json& json);
+
+
+struct WayCacheWeigher {
+    size_t operator()(const std::pair<nlohmann::json, std::time_t>& way_value) const {
+        return sizeof(way_value) + JsonByteSize(way_value.first);
+    };
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_CACHE_WEIGHER_HPP_
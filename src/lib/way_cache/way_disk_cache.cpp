@@ -0,0 +1,313 @@
+#include "way_disk_cache.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+namespace {
+
+const std::string kJournalFileName = "ways.journal";
+const std::string kCompactFileName = "ways.journal.tmp";
+
+const nlohmann::json::json_pointer kRecordKey{"/key"};
+const nlohmann::json::json_pointer kRecordStamp{"/stamp"};
+const nlohmann::json::json_pointer kRecordValue{"/value"};
+const nlohmann::json::json_pointer kRecordErased{"/erased"};
+
+constexpr size_t kMinCompactSize = 1024 * 1024;
+
+std::time_t CurrentTime() {
+    return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+}
+
+std::optional<std::string> ReadRecord(std::ifstream& journal_file, std::streamoff offset, size_t length) {
+    std::string record_line(length, '\0');
+
+    journal_file.seekg(offset);
+    journal_file.read(record_line.data(), length);
+
+    if (journal_file.gcount() != static_cast<std::streamsize>(length)) {
+        journal_file.clear();
+        return {};
+    }
+
+    return record_line;
+}
+
+// flushes a written file, or the entries of a directory after a rename in it, to the disk
+bool SyncPath(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    const bool is_synced = ::fsync(fd) == 0;
+    ::close(fd);
+
+    return is_synced;
+}
+
+} // namespace
+
+
+WayDiskCache::WayDiskCache(const std::string& cache_dir_path, std::time_t lifetime)
+  : journal_path_{std::filesystem::path{cache_dir_path} / kJournalFileName}, lifetime_{lifetime} {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_path, ec);
+
+    Load();
+
+    if (NeedCompact()) {
+        Compact();
+    }
+
+    if (!journal_file_.is_open()) {
+        journal_file_.open(journal_path_, std::ios::binary | std::ios::app);
+    }
+}
+
+
+void WayDiskCache::Load() {
+    std::ifstream journal_file{journal_path_, std::ios::binary};
+
+    if (!journal_file.is_open())
+        return;
+
+    std::string record_line;
+    std::streamoff offset = 0;
+
+    while (std::getline(journal_file, record_line)) {
+        if (journal_file.eof()) {
+            // last record has no line end, it was torn by crash
+            break;
+        }
+
+        const std::streamoff record_offset = offset;
+        offset += record_line.size() + 1;
+
+        nlohmann::json record = nlohmann::json::parse(record_line, nullptr, false);
+
+        // a corrupt record is skipped, the records after it are whole
+        if (record.is_discarded() || !record.contains(kRecordKey) || !record.at(kRecordKey).is_string()
+          || (record.contains(kRecordStamp) && !record.at(kRecordStamp).is_number_integer())) {
+            continue;
+        }
+
+        const std::string& key = record.at(kRecordKey).get_ref<const std::string&>();
+
+        if (auto index_itr = index_.find(key); index_itr != index_.end()) {
+            live_size_ -= index_itr->second.length + 1;
+            index_.erase(index_itr);
+        }
+
+        if (!record.contains(kRecordErased) && record.contains(kRecordStamp) && record.contains(kRecordValue)) {
+            index_.insert({key, RecordPos{record_offset, record_line.size(), record.at(kRecordStamp).get<std::time_t>()}});
+            live_size_ += record_line.size() + 1;
+        }
+    }
+
+    journal_file.close();
+    journal_size_ = offset;
+
+    // only the torn tail is cut
+    std::error_code ec;
+    if (std::filesystem::file_size(journal_path_, ec) != static_cast<uintmax_t>(offset) && !ec) {
+        std::filesystem::resize_file(journal_path_, offset, ec);
+    }
+}
+
+
+std::optional<WayDiskCache::ValueType> WayDiskCache::Get(const std::string& key) {
+    auto index_itr = index_.find(key);
+
+    if (index_itr == index_.end())
+        return {};
+
+    if (IsExpired(index_itr->second.stamp)) {
+        Erase(key);
+        return {};
+    }
+
+    std::ifstream journal_file{journal_path_, std::ios::binary};
+
+    if (!journal_file.is_open())
+        return {};
+
+    auto record_line = ReadRecord(journal_file, index_itr->second.offset, index_itr->second.length);
+
+    if (!record_line)
+        return {};
+
+    nlohmann::json record = nlohmann::json::parse(*record_line, nullptr, false);
+
+    if (record.is_discarded() || !record.contains(kRecordValue) || record.at(kRecordKey) != key)
+        return {};
+
+    return ValueType{std::move(record.at(kRecordValue)), index_itr->second.stamp};
+}
+
+
+std::optional<std::time_t> WayDiskCache::GetStamp(const std::string& key) const {
+    auto index_itr = index_.find(key);
+
+    if (index_itr == index_.end() || IsExpired(index_itr->second.stamp))
+        return {};
+
+    return index_itr->second.stamp;
+}
+
+
+bool WayDiskCache::Insert(const std::string& key, const ValueType& value) {
+    nlohmann::json record;
+    record[kRecordKey] = key;
+    record[kRecordStamp] = value.second;
+    record[kRecordValue] = value.first;
+
+    std::optional<RecordPos> record_pos;
+    if (!Append(record, record_pos))
+        return false;
+
+    if (auto index_itr = index_.find(key); index_itr != index_.end()) {
+        live_size_ -= index_itr->second.length + 1;
+        index_itr->second = *record_pos;
+    } else {
+        index_.insert({key, *record_pos});
+    }
+    live_size_ += record_pos->length + 1;
+
+    if (NeedCompact()) {
+        Compact();
+    }
+
+    return true;
+}
+
+
+void WayDiskCache::Erase(const std::string& key) {
+    auto index_itr = index_.find(key);
+
+    if (index_itr == index_.end())
+        return;
+
+    live_size_ -= index_itr->second.length + 1;
+    index_.erase(index_itr);
+
+    nlohmann::json record;
+    record[kRecordKey] = key;
+    record[kRecordErased] = true;
+
+    std::optional<RecordPos> record_pos;
+    Append(record, record_pos);
+}
+
+
+bool WayDiskCache::Append(const nlohmann::json& record, std::optional<RecordPos>& record_pos) {
+    if (!journal_file_.is_open())
+        return false;
+
+    std::string record_line = record.dump();
+
+    journal_file_ << record_line << '\n';
+    journal_file_.flush();
+
+    if (!journal_file_) {
+        journal_file_.clear();
+        return false;
+    }
+
+    record_pos = RecordPos{
+        static_cast<std::streamoff>(journal_size_), record_line.size(),
+        record.contains(kRecordStamp) ? record.at(kRecordStamp).get<std::time_t>() : 0
+    };
+    journal_size_ += record_line.size() + 1;
+
+    // the record is in the journal either way, it is reported lost unless it is on the disk
+    return SyncPath(journal_path_);
+}
+
+
+bool WayDiskCache::Compact() {
+    const std::filesystem::path compact_path = journal_path_.parent_path() / kCompactFileName;
+
+    std::ifstream journal_file{journal_path_, std::ios::binary};
+    std::ofstream compact_file{compact_path, std::ios::binary | std::ios::trunc};
+
+    if (!compact_file.is_open())
+        return false;
+
+    std::unordered_map<std::string, RecordPos> compact_index;
+    size_t compact_size = 0;
+
+    if (journal_file.is_open()) {
+        for (auto& [key, record_pos] : index_) {
+            if (IsExpired(record_pos.stamp))
+                continue;
+
+            auto record_line = ReadRecord(journal_file, record_pos.offset, record_pos.length);
+
+            if (!record_line)
+                continue;
+
+            compact_file << *record_line << '\n';
+            compact_index.insert({key, RecordPos{static_cast<std::streamoff>(compact_size), record_pos.length, record_pos.stamp}});
+            compact_size += record_pos.length + 1;
+        }
+    }
+
+    compact_file.flush();
+    compact_file.close();
+
+    // the compacted records are on the disk before they replace the journal
+    if (!compact_file || !SyncPath(compact_path)) {
+        std::error_code remove_ec;
+        std::filesystem::remove(compact_path, remove_ec);
+        return false;
+    }
+    journal_file.close();
+
+    journal_file_.close();
+
+    std::error_code ec;
+    std::filesystem::rename(compact_path, journal_path_, ec);
+
+    if (!ec) {
+        SyncPath(journal_path_.parent_path());
+    }
+
+    journal_file_.open(journal_path_, std::ios::binary | std::ios::app);
+
+    if (ec)
+        return false;
+
+    index_ = std::move(compact_index);
+    journal_size_ = compact_size;
+    live_size_ = compact_size;
+
+    return true;
+}
+
+
+bool WayDiskCache::IsExpired(std::time_t stamp) const {
+    return CurrentTime() - stamp > lifetime_;
+}
+
+
+bool WayDiskCache::NeedCompact() const {
+    return journal_size_ > kMinCompactSize && journal_size_ > 2 * live_size_;
+}
+
+} // namespace waybuilder
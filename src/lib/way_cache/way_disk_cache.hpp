@@ -0,0 +1,67 @@
+#ifndef _WAY_DISK_CACHE_HPP_
+#define _WAY_DISK_CACHE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+// Append-only journal of way responses, one json record per line.
+// Records are synced to the disk as they are appended. A torn tail record
+// is dropped on load and corrupt records are skipped. Compaction rewrites
+// live records into a synced temporary file and renames it over the journal.
+class WayDiskCache {
+ public:
+    using ValueType = std::pair<nlohmann::json, std::time_t>;
+
+ public:
+    WayDiskCache(const std::string& cache_dir_path, std::time_t lifetime);
+
+ public:
+    std::optional<ValueType> Get(const std::string& key);
+    // stamp of a live record, the record itself is not read
+    std::optional<std::time_t> GetStamp(const std::string& key) const;
+    bool Insert(const std::string& key, const ValueType& value);
+    void Erase(const std::string& key);
+    bool Compact();
+
+ public:
+    size_t Size() const { return index_.size(); };
+    const std::filesystem::path& GetPath() const { return journal_path_; };
+
+ private:
+    struct RecordPos {
+        std::streamoff offset;
+        size_t length;
+        std::time_t stamp;
+    };
+
+ private:
+    void Load();
+    bool Append(const nlohmann::json& record, std::optional<RecordPos>& record_pos);
+    bool IsExpired(std::time_t stamp) const;
+    bool NeedCompact() const;
+
+ private:
+    std::unordered_map<std::string, RecordPos> index_;
+
+    std::filesystem::path journal_path_;
+    std::ofstream journal_file_;
+    std::time_t lifetime_;
+
+    size_t journal_size_ = 0;
+    size_t live_size_ = 0;
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_DISK_CACHE_HPP_
@@ -0,0 +1,235 @@
+#include "way_query_predictor.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "way_cache_key.hpp"
+
+namespace waybuilder {
+
+namespace {
+
+const std::string kHistoryFileName = "queries.history";
+const std::string kCompactFileName = "queries.history.tmp";
+
+} // namespace
+
+
+WayQueryPredictor::WayQueryPredictor(const std::string& history_dir_path)
+  : history_path_{std::filesystem::path{history_dir_path} / kHistoryFileName} {
+    std::error_code ec;
+    std::filesystem::create_directories(history_dir_path, ec);
+
+    Load();
+
+    if (file_record_count_ > 2 * kHistorySize) {
+        Compact();
+    }
+
+    if (!history_file_.is_open()) {
+        history_file_.open(history_path_, std::ios::app);
+    }
+}
+
+
+void WayQueryPredictor::Observe(const WayQuery& query) {
+    auto day = WayCacheKeyFactory::ParseDay(query.date);
+
+    if (!day || *day == WayCacheKey::kAnyDay) {
+        return;
+    }
+
+    Record record{query.from_point, query.to_point, *day};
+
+    // a repeated query tells nothing about the next one
+    if (!history_.empty() && history_.back().from_point == record.from_point
+      && history_.back().to_point == record.to_point && history_.back().day == record.day) {
+        return;
+    }
+
+    Learn(record);
+    Append(record);
+
+    if (file_record_count_ > 2 * kHistorySize) {
+        Compact();
+    }
+}
+
+
+std::vector<WayQuery> WayQueryPredictor::Predict(const WayQuery& query, size_t max_count) const {
+    auto day = WayCacheKeyFactory::ParseDay(query.date);
+
+    if (pair_count_ < kMinObservations || !day || *day == WayCacheKey::kAnyDay) {
+        return {};
+    }
+
+    std::vector<Transition> transitions;
+
+    for (size_t transition_index = 0; transition_index < transition_counts_.size(); ++transition_index) {
+        if (transition_counts_[transition_index] >= kMinProbability * pair_count_) {
+            transitions.push_back(static_cast<Transition>(transition_index));
+        }
+    }
+
+    std::stable_sort(transitions.begin(), transitions.end(), [this](Transition lhs, Transition rhs) {
+        return GetTransitionCount(lhs) > GetTransitionCount(rhs);
+    });
+
+    const Record record{query.from_point, query.to_point, *day};
+    std::vector<WayQuery> predictions;
+
+    for (size_t transition_index = 0; transition_index < std::min(max_count, transitions.size()); ++transition_index) {
+        Record next = Apply(record, transitions[transition_index]);
+        predictions.push_back(WayQuery{std::move(next.from_point), std::move(next.to_point), WayCacheKeyFactory::FormatDay(next.day)});
+    }
+
+    return predictions;
+}
+
+
+bool WayQueryPredictor::HasPair(const std::string& from_point, const std::string& to_point) const {
+    return std::any_of(history_.begin(), history_.end(), [&from_point, &to_point](const Record& record) {
+        return record.from_point == from_point && record.to_point == to_point;
+    });
+}
+
+
+auto WayQueryPredictor::Classify(const Record& prev, const Record& next) -> std::optional<Transition> {
+    const int32_t day_shift = next.day - prev.day;
+
+    if (prev.from_point == next.from_point && prev.to_point == next.to_point) {
+        if (day_shift == 1) {
+            return Transition::NEXT_DAY;
+        } else if (day_shift == -1) {
+            return Transition::PREV_DAY;
+        }
+    } else if (prev.from_point == next.to_point && prev.to_point == next.from_point) {
+        if (day_shift == 0) {
+            return Transition::RETURN;
+        } else if (day_shift == 1) {
+            return Transition::RETURN_NEXT_DAY;
+        }
+    }
+
+    return {};
+}
+
+
+auto WayQueryPredictor::Apply(const Record& record, Transition transition) -> Record {
+    switch (transition) {
+        case Transition::RETURN:
+            return Record{record.to_point, record.from_point, record.day};
+        case Transition::NEXT_DAY:
+            return Record{record.from_point, record.to_point, record.day + 1};
+        case Transition::PREV_DAY:
+            return Record{record.from_point, record.to_point, record.day - 1};
+        case Transition::RETURN_NEXT_DAY:
+            return Record{record.to_point, record.from_point, record.day + 1};
+        default:
+            return record;
+    }
+}
+
+
+void WayQueryPredictor::Learn(const Record& record) {
+    if (!history_.empty()) {
+        if (auto transition = Classify(history_.back(), record); transition) {
+            ++transition_counts_[static_cast<size_t>(*transition)];
+        }
+        ++pair_count_;
+    }
+
+    history_.push_back(record);
+
+    if (history_.size() > kHistorySize) {
+        // the oldest pair leaves the statistics with its first query
+        if (auto transition = Classify(history_[0], history_[1]); transition) {
+            --transition_counts_[static_cast<size_t>(*transition)];
+        }
+        --pair_count_;
+
+        history_.pop_front();
+    }
+}
+
+
+void WayQueryPredictor::Load() {
+    std::ifstream history_file{history_path_};
+
+    if (!history_file.is_open())
+        return;
+
+    std::string from_point;
+    std::string to_point;
+    std::string date;
+
+    while (history_file >> from_point >> to_point >> date) {
+        ++file_record_count_;
+
+        if (auto day = WayCacheKeyFactory::ParseDay(date); day && *day != WayCacheKey::kAnyDay) {
+            Learn(Record{std::move(from_point), std::move(to_point), *day});
+        }
+    }
+}
+
+
+bool WayQueryPredictor::Append(const Record& record) {
+    if (!history_file_.is_open())
+        return false;
+
+    history_file_ << record.from_point << ' ' << record.to_point << ' ' << WayCacheKeyFactory::FormatDay(record.day) << '\n';
+    history_file_.flush();
+
+    if (!history_file_) {
+        history_file_.clear();
+        return false;
+    }
+
+    ++file_record_count_;
+    return true;
+}
+
+
+bool WayQueryPredictor::Compact() {
+    const std::filesystem::path compact_path = history_path_.parent_path() / kCompactFileName;
+
+    std::ofstream compact_file{compact_path, std::ios::trunc};
+
+    if (!compact_file.is_open())
+        return false;
+
+    for (const auto& record : history_) {
+        compact_file << record.from_point << ' ' << record.to_point << ' ' << WayCacheKeyFactory::FormatDay(record.day) << '\n';
+    }
+
+    compact_file.flush();
+    if (!compact_file) {
+        compact_file.close();
+        std::filesystem::remove(compact_path);
+        return false;
+    }
+    compact_file.close();
+
+    history_file_.close();
+
+    std::error_code ec;
+    std::filesystem::rename(compact_path, history_path_, ec);
+
+    history_file_.open(history_path_, std::ios::app);
+
+    if (ec)
+        return false;
+
+    file_record_count_ = history_.size();
+    return true;
+}
+
+} // namespace waybuilder
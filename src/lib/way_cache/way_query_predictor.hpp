@@ -0,0 +1,84 @@
+#ifndef _WAY_QUERY_PREDICTOR_HPP_
+#define _WAY_QUERY_PREDICTOR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace waybuilder {
+
+struct WayQuery {
+    std::string from_point;
+    std::string to_point;
+    // yyyy-mm-dd
+    std::string date;
+};
+
+
+// Learns how consecutive way queries relate from a persisted history of the
+// last kHistorySize queries: return leg, next day, previous day or the return
+// leg of the next day. Predicts the next queries by transition frequency.
+// History is an append-only file of "from to date" lines, rewritten with the
+// last queries when it grows twice over the history size.
+class WayQueryPredictor {
+ public:
+    enum class Transition : uint8_t { RETURN, NEXT_DAY, PREV_DAY, RETURN_NEXT_DAY, kCount };
+
+    static constexpr size_t kHistorySize = 256;
+    // fewer observed pairs give no prediction
+    static constexpr size_t kMinObservations = 4;
+    static constexpr double kMinProbability = 0.2;
+
+ public:
+    WayQueryPredictor(const std::string& history_dir_path);
+
+ public:
+    // appends the query to the history, learns its relation to the previous one
+    void Observe(const WayQuery& query);
+
+    // likely next queries, most probable first
+    std::vector<WayQuery> Predict(const WayQuery& query, size_t max_count) const;
+
+    // the pair is in the history, any date
+    bool HasPair(const std::string& from_point, const std::string& to_point) const;
+
+ public:
+    size_t Size() const { return history_.size(); };
+    size_t GetTransitionCount(Transition transition) const { return transition_counts_[static_cast<size_t>(transition)]; };
+
+ private:
+    struct Record {
+        std::string from_point;
+        std::string to_point;
+        int32_t day;
+    };
+
+ private:
+    static std::optional<Transition> Classify(const Record& prev, const Record& next);
+    static Record Apply(const Record& record, Transition transition);
+
+    void Learn(const Record& record);
+    void Load();
+    bool Append(const Record& record);
+    bool Compact();
+
+ private:
+    std::deque<Record> history_;
+    std::array<size_t, static_cast<size_t>(Transition::kCount)> transition_counts_{};
+    // consecutive pairs in history, unrelated ones included
+    size_t pair_count_ = 0;
+
+    std::filesystem::path history_path_;
+    std::ofstream history_file_;
+    size_t file_record_count_ = 0;
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_QUERY_PREDICTOR_HPP_
@@ -0,0 +1,100 @@
+#include "way_refresher.hpp"
+
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace waybuilder {
+
+WayRefresher::WayRefresher(size_t worker_count) {
+    workers_.reserve(worker_count);
+
+    for (size_t worker_index = 0; worker_index < worker_count; ++worker_index) {
+        workers_.emplace_back(&WayRefresher::WorkerLoop, this);
+    }
+}
+
+
+WayRefresher::~WayRefresher() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+        jobs_.clear();
+    }
+
+    jobs_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+bool WayRefresher::Schedule(const WayCacheKey& key, FetchFuncType fetch) {
+    {
+        std::lock_guard lock{mutex_};
+
+        if (!pending_keys_.insert(key).second) {
+            return false;
+        }
+
+        jobs_.emplace_back(key, std::move(fetch));
+    }
+
+    jobs_cv_.notify_one();
+    return true;
+}
+
+
+std::vector<WayRefresher::ResultType> WayRefresher::TakeResults() {
+    std::vector<ResultType> results;
+
+    std::lock_guard lock{mutex_};
+    results.swap(results_);
+
+    for (auto& [key, value] : results) {
+        pending_keys_.erase(key);
+    }
+
+    std::erase_if(results, [](const ResultType& result) { return !result.second; });
+
+    return results;
+}
+
+
+size_t WayRefresher::GetPendingCount() const {
+    std::lock_guard lock{mutex_};
+    return pending_keys_.size();
+}
+
+
+void WayRefresher::WorkerLoop() {
+    std::unique_lock lock{mutex_};
+
+    while (true) {
+        jobs_cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+
+        if (stop_) {
+            return;
+        }
+
+        auto [key, fetch] = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        lock.unlock();
+
+        ValueHandle value;
+        try {
+            value = fetch();
+        } catch (const std::exception&) {
+            // a failed refresh keeps the cached value until it expires
+        }
+
+        lock.lock();
+
+        results_.emplace_back(key, std::move(value));
+    }
+}
+
+} // namespace waybuilder
@@ -0,0 +1,67 @@
+#ifndef _WAY_REFRESHER_HPP_
+#define _WAY_REFRESHER_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "way_cache_key.hpp"
+
+namespace waybuilder {
+
+// Background workers refreshing cached ways: fetch functions run on a small
+// pool of worker threads, fetched values wait until the owner takes them
+// on its own thread. A key is scheduled at most once until it is taken.
+class WayRefresher {
+ public:
+    using ValueType = std::pair<nlohmann::json, std::time_t>;
+    using ValueHandle = std::shared_ptr<const ValueType>;
+    using FetchFuncType = std::function<ValueHandle()>;
+    using ResultType = std::pair<WayCacheKey, ValueHandle>;
+
+    static constexpr size_t kDefaultWorkerCount = 4;
+
+ public:
+    explicit WayRefresher(size_t worker_count = kDefaultWorkerCount);
+    ~WayRefresher();
+
+    WayRefresher(const WayRefresher&) = delete;
+    WayRefresher& operator=(const WayRefresher&) = delete;
+
+ public:
+    bool Schedule(const WayCacheKey& key, FetchFuncType fetch);
+
+    // fetched values, failed fetches are dropped
+    std::vector<ResultType> TakeResults();
+
+ public:
+    size_t GetPendingCount() const;
+
+ private:
+    void WorkerLoop();
+
+ private:
+    mutable std::mutex mutex_;
+    std::condition_variable jobs_cv_;
+
+    std::deque<std::pair<WayCacheKey, FetchFuncType>> jobs_;
+    std::unordered_set<WayCacheKey> pending_keys_;
+    std::vector<ResultType> results_;
+    bool stop_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_REFRESHER_HPP_
@@ -0,0 +1,190 @@
+#include "way_schedule_template.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "way_cache_key.hpp"
+
+namespace waybuilder {
+
+namespace {
+
+const nlohmann::json::json_pointer kSegments{"/segments"};
+const nlohmann::json::json_pointer kIntervalSegments{"/interval_segments"};
+const nlohmann::json::json_pointer kSearch{"/search"};
+const nlohmann::json::json_pointer kSearchDate{"/date"};
+const nlohmann::json::json_pointer kHasTransfers{"/has_transfers"};
+const nlohmann::json::json_pointer kDeparture{"/departure"};
+const nlohmann::json::json_pointer kArrival{"/arrival"};
+const nlohmann::json::json_pointer kDuration{"/duration"};
+const nlohmann::json::json_pointer kStartDate{"/start_date"};
+const nlohmann::json::json_pointer kDaysMask{"/days_mask"};
+const nlohmann::json::json_pointer kPaginationTotal{"/pagination/total"};
+const nlohmann::json::json_pointer kPaginationLimit{"/pagination/limit"};
+const nlohmann::json::json_pointer kPaginationOffset{"/pagination/offset"};
+
+constexpr int32_t kSecondsInDay = 24 * 60 * 60;
+constexpr size_t kTimeSize = 8;
+
+// "HH:MM:SS" or "yyyy-mm-ddTHH:MM:SS+hh:mm" into time of day and utc offset
+bool SplitTime(std::string_view date_time, std::string& time, std::string& zone) {
+    if (size_t time_pos = date_time.find('T'); time_pos != std::string_view::npos) {
+        date_time.remove_prefix(time_pos + 1);
+    }
+
+    if (date_time.size() < kTimeSize || date_time[2] != ':' || date_time[5] != ':') {
+        return false;
+    }
+
+    time = date_time.substr(0, kTimeSize);
+    zone = date_time.substr(kTimeSize);
+    return true;
+}
+
+std::optional<int32_t> TimeSeconds(std::string_view time) {
+    int32_t hours = 0;
+    int32_t minutes = 0;
+    int32_t seconds = 0;
+
+    auto parse_field = [&time](size_t pos, int32_t& field) {
+        auto [ptr, ec] = std::from_chars(time.data() + pos, time.data() + pos + 2, field);
+        return ec == std::errc{} && ptr == time.data() + pos + 2;
+    };
+
+    if (!parse_field(0, hours) || !parse_field(3, minutes) || !parse_field(6, seconds)) {
+        return {};
+    }
+
+    return hours * 60 * 60 + minutes * 60 + seconds;
+}
+
+} // namespace
+
+
+WayScheduleTemplate::WayScheduleTemplate(const nlohmann::json& ways_json) {
+    if (!ways_json.contains(kSegments) || !ways_json.at(kSegments).is_array()) {
+        return;
+    }
+
+    if (ways_json.contains(kIntervalSegments) && !ways_json.at(kIntervalSegments).empty()) {
+        return;
+    }
+
+    // a search cut to its first page misses threads, dates of those would render wrong
+    if (ways_json.contains(kPaginationTotal) && ways_json.at(kPaginationTotal).is_number_unsigned()
+      && ways_json.at(kPaginationTotal).get<size_t>() > ways_json.at(kSegments).size()) {
+        return;
+    }
+
+    first_day_ = std::numeric_limits<int32_t>::max();
+    end_day_ = std::numeric_limits<int32_t>::min();
+
+    for (const auto& segment : ways_json.at(kSegments)) {
+        if (!AddThread(segment)) {
+            threads_.clear();
+            return;
+        }
+    }
+
+    if (threads_.empty()) {
+        return;
+    }
+
+    search_ = ways_json.contains(kSearch) ? ways_json.at(kSearch) : nlohmann::json::object();
+    is_valid_ = true;
+}
+
+
+nlohmann::json WayScheduleTemplate::Render(int32_t day) const {
+    if (!Covers(day)) {
+        return {};
+    }
+
+    nlohmann::json ways_json;
+    nlohmann::json& segments = ways_json[kSegments] = nlohmann::json::array();
+
+    const std::string date = WayCacheKeyFactory::FormatDay(day);
+
+    for (const auto& thread : threads_) {
+        const int32_t mask_index = day - thread.start_day;
+
+        if (mask_index < 0 || mask_index >= static_cast<int32_t>(thread.days_mask.size()) || thread.days_mask[mask_index] != '1') {
+            continue;
+        }
+
+        nlohmann::json& segment = segments.emplace_back(thread.segment);
+        segment[kDeparture] = date + 'T' + thread.departure_time + thread.departure_zone;
+        segment[kArrival] = WayCacheKeyFactory::FormatDay(day + thread.arrival_day_shift) + 'T' + thread.arrival_time + thread.arrival_zone;
+        segment[kStartDate] = date;
+    }
+
+    ways_json[kSearch] = search_;
+    ways_json[kSearch / kSearchDate] = date;
+    ways_json[kIntervalSegments] = nlohmann::json::array();
+    ways_json[kPaginationTotal] = segments.size();
+    ways_json[kPaginationLimit] = segments.size();
+    ways_json[kPaginationOffset] = 0;
+
+    return ways_json;
+}
+
+
+bool WayScheduleTemplate::AddThread(const nlohmann::json& segment) {
+    if (segment.contains(kHasTransfers) && segment.at(kHasTransfers).is_boolean() && segment.at(kHasTransfers).get<bool>()) {
+        return false;
+    }
+
+    if (!segment.contains(kDeparture) || !segment.at(kDeparture).is_string()
+      || !segment.contains(kArrival) || !segment.at(kArrival).is_string()
+      || !segment.contains(kDuration) || !segment.at(kDuration).is_number()
+      || !segment.contains(kStartDate) || !segment.at(kStartDate).is_string()
+      || !segment.contains(kDaysMask) || !segment.at(kDaysMask).is_string()) {
+        return false;
+    }
+
+    Thread thread;
+
+    if (!SplitTime(segment.at(kDeparture).get_ref<const std::string&>(), thread.departure_time, thread.departure_zone)
+      || !SplitTime(segment.at(kArrival).get_ref<const std::string&>(), thread.arrival_time, thread.arrival_zone)) {
+        return false;
+    }
+
+    auto departure_seconds = TimeSeconds(thread.departure_time);
+    auto arrival_seconds = TimeSeconds(thread.arrival_time);
+    auto start_day = WayCacheKeyFactory::ParseDay(segment.at(kStartDate).get_ref<const std::string&>());
+
+    if (!departure_seconds || !arrival_seconds || !start_day || *start_day == WayCacheKey::kAnyDay) {
+        return false;
+    }
+
+    thread.days_mask = segment.at(kDaysMask).get<std::string>();
+
+    if (thread.days_mask.find_first_not_of("01") != std::string::npos) {
+        return false;
+    }
+
+    // arrival zone may differ from departure zone by less than half a day
+    const double arrival_shift = (*departure_seconds + segment.at(kDuration).get<double>() - *arrival_seconds) / kSecondsInDay;
+    thread.arrival_day_shift = static_cast<int32_t>(std::lround(arrival_shift));
+    thread.start_day = *start_day;
+
+    thread.segment = segment;
+    thread.segment.erase(kDaysMask.back());
+
+    first_day_ = std::min(first_day_, thread.start_day);
+    end_day_ = std::max(end_day_, thread.start_day + static_cast<int32_t>(thread.days_mask.size()));
+
+    threads_.push_back(std::move(thread));
+    return true;
+}
+
+} // namespace waybuilder
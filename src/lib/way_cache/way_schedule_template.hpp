@@ -0,0 +1,60 @@
+#ifndef _WAY_SCHEDULE_TEMPLATE_HPP_
+#define _WAY_SCHEDULE_TEMPLATE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+// Ways of a point pair for any date, built from one search without date and
+// with days masks: every thread keeps its segment, times of day and the mask
+// of days it runs. Render gives the ways json of a date in the layout of a
+// dated search. Pairs with transfer or interval segments, threads without
+// a mask, or more threads than one page holds give an invalid template and
+// are searched by date.
+class WayScheduleTemplate {
+ public:
+    WayScheduleTemplate() = default;
+    explicit WayScheduleTemplate(const nlohmann::json& ways_json);
+
+ public:
+    bool IsValid() const { return is_valid_; };
+    size_t Size() const { return threads_.size(); };
+
+    // day is inside the masks, days since epoch
+    bool Covers(int32_t day) const { return is_valid_ && first_day_ <= day && day < end_day_; };
+
+    nlohmann::json Render(int32_t day) const;
+
+ private:
+    struct Thread {
+        nlohmann::json segment;
+        // HH:MM:SS and the utc offset suffix, if any
+        std::string departure_time;
+        std::string departure_zone;
+        std::string arrival_time;
+        std::string arrival_zone;
+        int32_t arrival_day_shift;
+        int32_t start_day;
+        // '1' for a running day, the first char is start_day
+        std::string days_mask;
+    };
+
+ private:
+    bool AddThread(const nlohmann::json& segment);
+
+ private:
+    std::vector<Thread> threads_;
+    nlohmann::json search_;
+    int32_t first_day_ = 0;
+    int32_t end_day_ = 0;
+    bool is_valid_ = false;
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_SCHEDULE_TEMPLATE_HPP_
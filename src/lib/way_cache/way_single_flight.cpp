@@ -0,0 +1,64 @@
+#include "way_single_flight.hpp"
+
+#include <exception>
+#include <future>
+#include <mutex>
+#include <utility>
+
+namespace waybuilder {
+
+auto WaySingleFlight::Do(const WayCacheKey& key, const FetchFuncType& fetch) -> ResultType {
+    std::promise<ResultType> flight_promise;
+
+    {
+        std::unique_lock lock{mutex_};
+
+        if (auto flight_it = flights_.find(key); flight_it != flights_.end()) {
+            std::shared_future<ResultType> flight = flight_it->second;
+            ++coalesced_count_;
+            lock.unlock();
+
+            ResultType result = flight.get();
+            result.is_shared = true;
+            return result;
+        }
+
+        flights_.emplace(key, flight_promise.get_future().share());
+    }
+
+    ResultType result;
+
+    try {
+        result = fetch();
+    } catch (const std::exception&) {
+        // waiting callers get the failed status, the leader rethrows
+        {
+            std::lock_guard lock{mutex_};
+            flights_.erase(key);
+        }
+        flight_promise.set_value(ResultType{});
+        throw;
+    }
+
+    {
+        std::lock_guard lock{mutex_};
+        flights_.erase(key);
+    }
+    flight_promise.set_value(result);
+
+    return result;
+}
+
+
+size_t WaySingleFlight::GetCoalescedCount() const {
+    std::lock_guard lock{mutex_};
+    return coalesced_count_;
+}
+
+
+size_t WaySingleFlight::GetInFlightCount() const {
+    std::lock_guard lock{mutex_};
+    return flights_.size();
+}
+
+} // namespace waybuilder
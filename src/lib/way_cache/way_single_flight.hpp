@@ -0,0 +1,59 @@
+#ifndef _WAY_SINGLE_FLIGHT_HPP_
+#define _WAY_SINGLE_FLIGHT_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include "way_cache_key.hpp"
+
+namespace waybuilder {
+
+// Coalescing of concurrent identical way searches: the first caller of a key
+// runs the search, callers arriving while it is in flight wait for it and
+// share its status and parsed ways. Nothing is kept once the search is done.
+class WaySingleFlight {
+ public:
+    using ValueType = std::pair<nlohmann::json, std::time_t>;
+    using ValueHandle = std::shared_ptr<const ValueType>;
+
+    struct ResultType {
+        long status_code = 0;
+        // empty unless the response is parsed
+        ValueHandle value;
+        // result of a search run by another caller
+        bool is_shared = false;
+    };
+
+    using FetchFuncType = std::function<ResultType()>;
+
+ public:
+    WaySingleFlight() = default;
+
+    WaySingleFlight(const WaySingleFlight&) = delete;
+    WaySingleFlight& operator=(const WaySingleFlight&) = delete;
+
+ public:
+    ResultType Do(const WayCacheKey& key, const FetchFuncType& fetch);
+
+ public:
+    size_t GetCoalescedCount() const;
+    size_t GetInFlightCount() const;
+
+ private:
+    mutable std::mutex mutex_;
+
+    std::unordered_map<WayCacheKey, std::shared_future<ResultType>> flights_;
+    size_t coalesced_count_ = 0;
+};
+
+} // namespace waybuilder
+
+#endif // _WAY_SINGLE_FLIGHT_HPP_
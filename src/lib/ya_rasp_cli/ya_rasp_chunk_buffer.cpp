@@ -0,0 +1,74 @@
+#include "ya_rasp_chunk_buffer.hpp"
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace waybuilder {
+
+bool YaRaspChunkBuffer::Push(std::string_view chunk) {
+    std::unique_lock lock{mutex_};
+
+    // a chunk is taken while the queue is under the limit, whatever its size
+    chunks_cv_.wait(lock, [this]() { return is_canceled_ || queued_size_ < max_size_; });
+
+    if (is_canceled_ || is_closed_) {
+        return false;
+    }
+
+    if (!chunk.empty()) {
+        chunks_.emplace_back(chunk);
+        queued_size_ += chunk.size();
+    }
+
+    lock.unlock();
+    chunks_cv_.notify_all();
+    return true;
+}
+
+
+void YaRaspChunkBuffer::Close() {
+    {
+        std::lock_guard lock{mutex_};
+        is_closed_ = true;
+    }
+    chunks_cv_.notify_all();
+}
+
+
+void YaRaspChunkBuffer::Cancel() {
+    {
+        std::lock_guard lock{mutex_};
+        is_canceled_ = true;
+        chunks_.clear();
+        queued_size_ = 0;
+    }
+    chunks_cv_.notify_all();
+}
+
+
+YaRaspChunkBuffer::int_type YaRaspChunkBuffer::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::unique_lock lock{mutex_};
+    chunks_cv_.wait(lock, [this]() { return is_canceled_ || is_closed_ || !chunks_.empty(); });
+
+    if (chunks_.empty()) {
+        return traits_type::eof();
+    }
+
+    current_chunk_ = std::move(chunks_.front());
+    chunks_.pop_front();
+    queued_size_ -= current_chunk_.size();
+
+    lock.unlock();
+    chunks_cv_.notify_all();
+
+    setg(current_chunk_.data(), current_chunk_.data(), current_chunk_.data() + current_chunk_.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+} // namespace waybuilder
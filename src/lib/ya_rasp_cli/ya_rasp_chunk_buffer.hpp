@@ -0,0 +1,56 @@
+#ifndef _YA_RASP_CHUNK_BUFFER_HPP_
+#define _YA_RASP_CHUNK_BUFFER_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace waybuilder {
+
+// Stream buffer between a download and a parser on another thread: the
+// download pushes body chunks as they arrive, the parser reads them through
+// an istream and waits for more. At most max_size bytes wait unread, a push
+// blocks until the parser catches up. Push fails once the reader cancels,
+// so a transfer is stopped when its body can not be parsed anyway.
+class YaRaspChunkBuffer : public std::streambuf {
+ public:
+    static constexpr size_t kDefaultMaxSize = 1 << 20;
+
+ public:
+    explicit YaRaspChunkBuffer(size_t max_size = kDefaultMaxSize) : max_size_{max_size} {  };
+
+    YaRaspChunkBuffer(const YaRaspChunkBuffer&) = delete;
+    YaRaspChunkBuffer& operator=(const YaRaspChunkBuffer&) = delete;
+
+ public:
+    // writer side
+    bool Push(std::string_view chunk);
+    void Close();
+
+    // reader side
+    void Cancel();
+
+ protected:
+    int_type underflow() override;
+
+ private:
+    std::mutex mutex_;
+    std::condition_variable chunks_cv_;
+
+    std::deque<std::string> chunks_;
+    size_t queued_size_ = 0;
+    size_t max_size_;
+    bool is_closed_ = false;
+    bool is_canceled_ = false;
+
+    // chunk under the get area
+    std::string current_chunk_;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_CHUNK_BUFFER_HPP_
@@ -1,16 +1,20 @@
 #include "ya_rasp_cli.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <sstream>
-#include <span>
-#include <type_traits>
+#include <system_error>
 #include <string>
 #include <string_view>
 #include <optional>
+#include <ranges>
 #include <ostream>
+#include <istream>
+#include <thread>
 
 #include <nlohmann/json.hpp>
 
@@ -32,41 +36,125 @@
 namespace waybuilder {
 
 YaRaspCli::YaRaspCli(const std::string& api_key, const std::string& point_list_path,
-    const std::string& api_cfg_path, const std::string& api_lang, const std::string& log_dir_path)
- : api_key_{api_key}, point_list_path_{point_list_path}, api_cfg_path_{api_cfg_path}, api_lang_(api_lang), log_dir_path_(log_dir_path) {
-    std::ifstream point_list_file{point_list_path};
-    if (point_list_file.is_open()) {
-        point_list_ = nlohmann::json::parse(point_list_file);
-    }
-
+    const std::string& api_cfg_path, const std::string& api_lang, const std::string& log_dir_path,
+    std::unique_ptr<YaRaspTransport> transport)
+ : api_key_{api_key}, point_list_path_{point_list_path}, api_cfg_path_{api_cfg_path}, api_lang_(api_lang), log_dir_path_(log_dir_path),
+    transport_{std::move(transport)} {
     LogConfigurate(log_dir_path);
+    LoadPoints();
+    SchedulerConfigurate();
+    TransportConfigurate();
+    GuardConfigurate();
 }
 
 
-YaRaspCli::YaRaspCli(const std::string& api_cfg_path, const std::string& log_dir_path) : api_cfg_path_(api_cfg_path), log_dir_path_(log_dir_path) {
+YaRaspCli::YaRaspCli(const std::string& api_cfg_path, const std::string& log_dir_path, std::unique_ptr<YaRaspTransport> transport)
+  : transport_{std::move(transport)}, api_cfg_path_(api_cfg_path), log_dir_path_(log_dir_path) {
     LoadCfg();
     LogConfigurate(log_dir_path);
+    SchedulerConfigurate();
+    TransportConfigurate();
+    GuardConfigurate();
 }
 
 
 cpr::Response YaRaspCli::ScanPoints() {
     static const std::string_view kGetStationsUrl = "stations_list";
 
-    cpr::Response resp = cpr::Get(
-        cpr::Url{
-            BuildRequest(kGetStationsUrl, {{"lang", api_lang_}})
+    if (!points_guard_.Allow()) {
+        return UnavailableResponse(kGetStationsUrl);
+    }
+
+    if (!scheduler_.Acquire(RequestPriority::SCAN_POINTS)) {
+        return RefusedResponse(kGetStationsUrl);
+    }
+
+    const std::string url = BuildRequest(kGetStationsUrl, {{"lang", api_lang_}});
+    const std::filesystem::path scan_path = GetPointScanPath();
+    std::filesystem::path download_path = scan_path;
+    download_path += ".tmp";
+    std::optional<std::string> index_data;
+    bool is_list_written = false;
+
+    // the list is indexed on its own thread while the body is downloaded and
+    // written aside, the body is never held whole, a retry reads its own body
+    auto download = [this, &url, &download_path, &index_data, &is_list_written]() {
+        YaRaspChunkBuffer body_buffer;
+        bool is_write_refused = false;
+        std::ofstream list_file{download_path, std::ios::binary | std::ios::trunc};
+
+        std::thread parser{[&body_buffer, &index_data]() {
+            std::istream body_stream{&body_buffer};
+            index_data = YaRaspPointIndex::Build(body_stream);
+            body_buffer.Cancel();
+        }};
+
+        cpr::Response resp = transport_->Download(url,
+            cpr::WriteCallback{[&body_buffer, &is_write_refused, &list_file](std::string_view data, intptr_t) {
+                list_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                is_write_refused = !body_buffer.Push(data);
+                return !is_write_refused;
+            }},
+            points_timeout_
+        );
+
+        body_buffer.Close();
+        parser.join();
+
+        // the transfer was stopped by the parser, not by the network
+        if (is_write_refused) {
+            resp.error = cpr::Error{};
         }
-    );
 
-    if (resp.status_code != 200) {
+        // a malformed list is not retried
+        if (resp.status_code == 200 && !resp.error && !index_data) {
+            resp.status_code = 0;
+            resp.reason = "malformed points json";
+        }
+
+        is_list_written = static_cast<bool>(list_file.flush());
+        return resp;
+    };
+
+    cpr::Response resp = points_guard_.Run(download,
+        [this]() { return scheduler_.Acquire(RequestPriority::SCAN_POINTS); });
+
+    if (resp.status_code != 200 || resp.error) {
         BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
         << "api request error" << " | " 
         << "response code: " <<  resp.status_code << " | "
         << "reason: " <<  resp.reason << " | "
         << "request url: " <<  resp.url << " | "
-        << "text: " <<  resp.text;
+        << "error: " <<  resp.error.message;
+
+        // old points are kept, a broken transfer is reported failed
+        if (resp.status_code == 200) {
+            resp.status_code = 0;
+        }
+
+        // a list scanned before is still the one waiting for Save
+        std::error_code ec;
+        std::filesystem::remove(download_path, ec);
     } else {
-        point_list_ = nlohmann::json::parse(resp.text);
+        std::error_code ec;
+
+        if (is_list_written) {
+            std::filesystem::rename(download_path, scan_path, ec);
+        }
+
+        // Save fails rather than pair an older list with this index
+        if (!is_list_written || ec) {
+            std::filesystem::remove(download_path, ec);
+            std::filesystem::remove(scan_path, ec);
+
+            BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
+                << "points list error" << " | "
+                << "scanned list can not be written: " << scan_path.string();
+        }
+
+        // kept in memory, the list and index files are written on Save
+        scanned_index_ = *index_data;
+        point_index_.Assign(std::move(*index_data));
     }
 
     return resp;
@@ -76,31 +164,73 @@ cpr::Response YaRaspCli::ScanPoints() {
 cpr::Response YaRaspCli::ScanWays(const std::string& from_point, const std::string& to_point,
     const std::string& date, bool transfers, const std::string& transport_types, const std::string& system,
     const std::string& show_systems, size_t offset, size_t limit, bool add_days_mask,
-    const std::string& result_timezone) {
-    static const std::string_view kGetWaysUrl = "search";
+    const std::string& result_timezone, RequestPriority priority) {
+    WaySearchParams search{from_point, to_point, date, transfers, transport_types, system,
+        show_systems, offset, limit, add_days_mask, result_timezone};
+
+    return ScanWaysAsync({std::move(search)}, {}, priority).front().get();
+}
+
+
+std::vector<std::future<cpr::Response>> YaRaspCli::ScanWaysAsync(const std::vector<WaySearchParams>& searches,
+    ScanWaysCallbackType callback, RequestPriority priority) {
+    std::vector<std::future<cpr::Response>> responses;
+    responses.reserve(searches.size());
 
-    std::string offset_str{offset ? std::to_string(offset) : ""};
-    std::string transfers_str{transfers ? "true" : ""};
-    std::string limit_str{limit ? std::to_string(offset) : ""};
-    std::string add_days_mask_str{add_days_mask ? "true" : "false"};
-
-    cpr::Response resp = cpr::Get(
-        cpr::Url{
-            BuildRequest(kGetWaysUrl, {
-                {"lang", api_lang_},
-                {"from", from_point},
-                {"to", to_point},
-                {"date", date},
-                {"transport_types", transport_types},
-                {"system", system},
-                {"show_systems", show_systems},
-                {"offset", offset_str},
-                {"limit", limit_str},
-                {"add_days_mask", add_days_mask_str},
-                {"result_timezone", result_timezone},
-                {"transfers", transfers_str}
-            })
+    for (size_t search_index = 0; search_index < searches.size(); ++search_index) {
+        YaRaspRequestExecutor::CallbackType search_callback;
+
+        if (callback) {
+            search_callback = [callback, search_index](const cpr::Response& resp) { callback(search_index, resp); };
         }
+
+        // language is taken now, it may be changed before the request runs
+        responses.push_back(executor_->Submit(
+            [this, search = searches[search_index], lang = api_lang_, priority]() { return SearchWays(search, lang, priority); },
+            std::move(search_callback)
+        ));
+    }
+
+    return responses;
+}
+
+
+cpr::Response YaRaspCli::SearchWays(const WaySearchParams& search, const std::string& lang, RequestPriority priority) {
+    static const std::string_view kGetWaysUrl = "search";
+
+    if (!search_guard_.Allow()) {
+        return UnavailableResponse(kGetWaysUrl);
+    }
+
+    if (!scheduler_.Acquire(priority)) {
+        return RefusedResponse(kGetWaysUrl);
+    }
+
+    std::string offset_str{search.offset ? std::to_string(search.offset) : ""};
+    std::string transfers_str{search.transfers ? "true" : ""};
+    std::string limit_str{search.limit ? std::to_string(search.limit) : ""};
+    std::string add_days_mask_str{search.add_days_mask ? "true" : "false"};
+
+    const std::string url = BuildRequest(kGetWaysUrl, {
+            {"lang", lang},
+            {"from", search.from_point},
+            {"to", search.to_point},
+            {"date", search.date},
+            {"transport_types", search.transport_types},
+            {"system", search.system},
+            {"show_systems", search.show_systems},
+            {"offset", offset_str},
+            {"limit", limit_str},
+            {"add_days_mask", add_days_mask_str},
+            {"result_timezone", search.result_timezone},
+            {"transfers", transfers_str}
+        });
+
+    // retries and hedges are charged at the priority of the search,
+    // a hedge loser may outlive the call, the url is copied
+    cpr::Response resp = search_guard_.Run(
+        [this, url]() { return transport_->Get(url); },
+        [this, priority]() { return scheduler_.Acquire(priority); }
     );
 
     if (resp.status_code != 200) {
@@ -124,6 +254,23 @@ bool YaRaspCli::DumpCfg() {
     api_cfg_json[YaRaspJsonPtr::kApiUrl] = api_url_;
     api_cfg_json[YaRaspJsonPtr::kApiVersion] = api_version_; 
     api_cfg_json[YaRaspJsonPtr::kApiLang] = api_lang_; 
+    api_cfg_json[YaRaspJsonPtr::kCacheBudget] = cache_budget_;
+    api_cfg_json[YaRaspJsonPtr::kCacheGrace] = cache_grace_;
+    api_cfg_json[YaRaspJsonPtr::kWarmUpRoutes] = warm_up_routes_;
+    api_cfg_json[YaRaspJsonPtr::kWarmUpBudget] = warm_up_budget_;
+    api_cfg_json[YaRaspJsonPtr::kPrefetchBudget] = prefetch_budget_;
+    api_cfg_json[YaRaspJsonPtr::kDailyRequestLimit] = daily_request_limit_;
+    api_cfg_json[YaRaspJsonPtr::kRequestRate] = request_rate_;
+    api_cfg_json[YaRaspJsonPtr::kRequestBurst] = request_burst_;
+    api_cfg_json[YaRaspJsonPtr::kRequestTimeout] = request_timeout_.count();
+    api_cfg_json[YaRaspJsonPtr::kConnectTimeout] = connect_timeout_.count();
+    api_cfg_json[YaRaspJsonPtr::kMaxConnections] = max_connections_;
+    api_cfg_json[YaRaspJsonPtr::kPointsTimeout] = points_timeout_.count();
+    api_cfg_json[YaRaspJsonPtr::kRequestAttempts] = request_attempts_;
+    api_cfg_json[YaRaspJsonPtr::kRequestHedging] = request_hedging_;
+    api_cfg_json[YaRaspJsonPtr::kTransport] = transport_mode_;
+    api_cfg_json[YaRaspJsonPtr::kTransportCorpus] = transport_corpus_path_;
+    api_cfg_json[YaRaspJsonPtr::kReplayLatency] = replay_latency_;
     
     std::ofstream api_cfg_file{api_cfg_path_};
 
@@ -171,13 +318,87 @@ bool YaRaspCli::LoadCfg() {
         api_lang_ = "ru_RU";
     }
 
+    if (api_cfg_json.contains(YaRaspJsonPtr::kCacheBudget) && api_cfg_json.at(YaRaspJsonPtr::kCacheBudget).is_number_unsigned()) {
+        cache_budget_ = api_cfg_json.at(YaRaspJsonPtr::kCacheBudget);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kCacheGrace) && api_cfg_json.at(YaRaspJsonPtr::kCacheGrace).is_number_unsigned()) {
+        cache_grace_ = api_cfg_json.at(YaRaspJsonPtr::kCacheGrace);
+    }
 
-    
-    std::ifstream point_list_file{point_list_path_};
-    if (point_list_file.is_open()) {
-        point_list_ = nlohmann::json::parse(point_list_file);
+    if (api_cfg_json.contains(YaRaspJsonPtr::kWarmUpBudget) && api_cfg_json.at(YaRaspJsonPtr::kWarmUpBudget).is_number_unsigned()) {
+        warm_up_budget_ = api_cfg_json.at(YaRaspJsonPtr::kWarmUpBudget);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kPrefetchBudget) && api_cfg_json.at(YaRaspJsonPtr::kPrefetchBudget).is_number_unsigned()) {
+        prefetch_budget_ = api_cfg_json.at(YaRaspJsonPtr::kPrefetchBudget);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kDailyRequestLimit) && api_cfg_json.at(YaRaspJsonPtr::kDailyRequestLimit).is_number_unsigned()) {
+        daily_request_limit_ = api_cfg_json.at(YaRaspJsonPtr::kDailyRequestLimit);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kRequestRate) && api_cfg_json.at(YaRaspJsonPtr::kRequestRate).is_number()) {
+        request_rate_ = api_cfg_json.at(YaRaspJsonPtr::kRequestRate);
     }
 
+    if (api_cfg_json.contains(YaRaspJsonPtr::kRequestBurst) && api_cfg_json.at(YaRaspJsonPtr::kRequestBurst).is_number_unsigned()) {
+        request_burst_ = api_cfg_json.at(YaRaspJsonPtr::kRequestBurst);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kRequestTimeout) && api_cfg_json.at(YaRaspJsonPtr::kRequestTimeout).is_number_unsigned()) {
+        request_timeout_ = std::chrono::milliseconds{api_cfg_json.at(YaRaspJsonPtr::kRequestTimeout).get<int64_t>()};
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kConnectTimeout) && api_cfg_json.at(YaRaspJsonPtr::kConnectTimeout).is_number_unsigned()) {
+        connect_timeout_ = std::chrono::milliseconds{api_cfg_json.at(YaRaspJsonPtr::kConnectTimeout).get<int64_t>()};
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kMaxConnections) && api_cfg_json.at(YaRaspJsonPtr::kMaxConnections).is_number_unsigned()
+      && api_cfg_json.at(YaRaspJsonPtr::kMaxConnections).get<size_t>() > 0) {
+        max_connections_ = api_cfg_json.at(YaRaspJsonPtr::kMaxConnections);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kPointsTimeout) && api_cfg_json.at(YaRaspJsonPtr::kPointsTimeout).is_number_unsigned()) {
+        points_timeout_ = std::chrono::milliseconds{api_cfg_json.at(YaRaspJsonPtr::kPointsTimeout).get<int64_t>()};
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kRequestAttempts) && api_cfg_json.at(YaRaspJsonPtr::kRequestAttempts).is_number_unsigned()) {
+        request_attempts_ = api_cfg_json.at(YaRaspJsonPtr::kRequestAttempts);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kRequestHedging) && api_cfg_json.at(YaRaspJsonPtr::kRequestHedging).is_boolean()) {
+        request_hedging_ = api_cfg_json.at(YaRaspJsonPtr::kRequestHedging);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kTransport) && api_cfg_json.at(YaRaspJsonPtr::kTransport).is_string()) {
+        transport_mode_ = api_cfg_json.at(YaRaspJsonPtr::kTransport);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kTransportCorpus) && api_cfg_json.at(YaRaspJsonPtr::kTransportCorpus).is_string()) {
+        transport_corpus_path_ = api_cfg_json.at(YaRaspJsonPtr::kTransportCorpus);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kReplayLatency) && api_cfg_json.at(YaRaspJsonPtr::kReplayLatency).is_boolean()) {
+        replay_latency_ = api_cfg_json.at(YaRaspJsonPtr::kReplayLatency);
+    }
+
+    if (api_cfg_json.contains(YaRaspJsonPtr::kWarmUpRoutes)) {
+        try {
+            // [[from_id, to_id], ...]
+            warm_up_routes_ = api_cfg_json.at(YaRaspJsonPtr::kWarmUpRoutes).get<std::vector<RouteType>>();
+        } catch (nlohmann::json::exception& ex) {
+            BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
+                << "api config error" << " | "
+                << "warm up routes are ignored" << " | "
+                << "exception id: " << ex.id << " | "
+                << ex.what();
+        }
+    }
+
+
+    LoadPoints();
+
     return true;
 }
 
@@ -185,18 +406,83 @@ bool YaRaspCli::LoadCfg() {
 bool YaRaspCli::Save() {
     bool save_state = DumpCfg();
 
-    std::ofstream point_list_file{point_list_path_};
+    // nothing new to save, the list on disk is the indexed one
+    if (!scanned_index_) {
+        return save_state;
+    }
 
-    save_state = save_state && point_list_file.is_open();
+    std::error_code ec;
+    std::filesystem::rename(GetPointScanPath(), point_list_path_, ec);
 
-    if (point_list_file.is_open()) {
-        point_list_file << point_list_;
+    save_state = save_state && !ec;
+
+    if (!ec) {
+        // the index is written after the list, so it is not taken as stale
+        save_state = IndexPoints(std::move(*scanned_index_)) && save_state;
+        scanned_index_.reset();
     }
 
     return save_state;
 }
 
 
+std::filesystem::path YaRaspCli::GetPointIndexPath() const {
+    return std::filesystem::path{point_list_path_}.replace_extension(YaRaspPointIndex::kIndexExtension);
+}
+
+
+std::filesystem::path YaRaspCli::GetPointScanPath() const {
+    return std::filesystem::path{point_list_path_ + ".scan"};
+}
+
+
+bool YaRaspCli::LoadPoints() {
+    const std::filesystem::path index_path = GetPointIndexPath();
+
+    std::error_code ec;
+    const auto index_time = std::filesystem::last_write_time(index_path, ec);
+    const bool has_index = !ec;
+    const auto list_time = std::filesystem::last_write_time(point_list_path_, ec);
+    const bool has_list = !ec;
+
+    if (has_index && (!has_list || list_time <= index_time) && point_index_.Open(index_path)) {
+        return true;
+    }
+
+    std::ifstream point_list_file{point_list_path_, std::ios::binary};
+
+    if (!point_list_file.is_open())
+        return false;
+
+    auto index_data = YaRaspPointIndex::Build(point_list_file);
+
+    if (!index_data) {
+        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
+            << "points list error" << " | "
+            << "malformed points json: " << point_list_path_;
+        return false;
+    }
+
+    return IndexPoints(std::move(*index_data));
+}
+
+
+bool YaRaspCli::IndexPoints(std::string index_data) {
+    const std::filesystem::path index_path = GetPointIndexPath();
+
+    if (YaRaspPointIndex::Save(index_data, index_path) && point_index_.Open(index_path)) {
+        return true;
+    }
+
+    BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
+        << "points index error" << " | "
+        << "index is kept in memory, can not write: " << index_path.string();
+
+    point_index_.Assign(std::move(index_data));
+    return false;
+}
+
+
 std::string YaRaspCli::BuildRequest(std::string_view req_str, 
   std::initializer_list<std::pair<std::string_view, std::string_view>> args) {
     std::stringstream request_stream;
@@ -214,6 +500,73 @@ std::string YaRaspCli::BuildRequest(std::string_view req_str,
 };
 
 
+void YaRaspCli::SchedulerConfigurate() {
+    scheduler_.Configure(daily_request_limit_, request_rate_, request_burst_);
+
+    // counter of the day lives next to the api config,
+    // replayed sessions do not spend the real quota
+    if (transport_mode_ != kReplayTransport) {
+        scheduler_.Load(std::filesystem::path{api_cfg_path_}.replace_filename(kQuotaFileName));
+    }
+}
+
+
+void YaRaspCli::TransportConfigurate() {
+    if (!transport_ && transport_mode_ == kReplayTransport) {
+        transport_ = std::make_unique<YaRaspReplayTransport>(transport_corpus_path_, replay_latency_);
+    } else if (!transport_) {
+        transport_ = std::make_unique<YaRaspLiveTransport>(request_timeout_, connect_timeout_, max_connections_);
+
+        if (transport_mode_ == kRecordTransport) {
+            transport_ = std::make_unique<YaRaspRecordTransport>(std::move(transport_), transport_corpus_path_);
+        } else if (transport_mode_ != kLiveTransport) {
+            BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error)
+                << "api config error" << " | "
+                << "unknown transport: " << transport_mode_ << " | "
+                << "live transport is used";
+        }
+    }
+
+    executor_ = std::make_unique<YaRaspRequestExecutor>(max_connections_);
+}
+
+
+void YaRaspCli::GuardConfigurate() {
+    search_guard_.Configure(request_attempts_, request_hedging_, executor_.get());
+    // a duplicate of the stations list download is too heavy to hedge
+    points_guard_.Configure(request_attempts_, false);
+}
+
+
+cpr::Response YaRaspCli::RefusedResponse(std::string_view url) {
+    cpr::Response resp;
+    resp.status_code = 0;
+    resp.reason = "request refused by scheduler, daily budget is low";
+
+    BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::warning)
+        << "api request refused" << " | "
+        << "request: " << url << " | "
+        << "remaining budget: " << scheduler_.GetRemaining() << " | "
+        << "reason: " << resp.reason;
+
+    return resp;
+}
+
+
+cpr::Response YaRaspCli::UnavailableResponse(std::string_view url) {
+    cpr::Response resp;
+    resp.status_code = 0;
+    resp.reason = "request not sent, api circuit is open after repeated failures";
+
+    BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::warning)
+        << "api request failed fast" << " | "
+        << "request: " << url << " | "
+        << "reason: " << resp.reason;
+
+    return resp;
+}
+
+
 void YaRaspCli::LogConfigurate(const std::string& log_dir_path) {
     namespace logging = boost::log;
     namespace keywords = boost::log::keywords;
@@ -239,249 +592,105 @@ void YaRaspCli::LogConfigurate(const std::string& log_dir_path) {
 };
 
 
-std::optional<std::reference_wrapper<nlohmann::json>> YaRaspCli::CountryList() {
-    if (point_list_.empty())
-        return {};
-
-    try {
-        auto& country_list = point_list_.at(YaRaspJsonPtr::kCountry);
-        return country_list;
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-        return {};
-    }
-}
-
-
-std::optional<std::reference_wrapper<nlohmann::json>> YaRaspCli::RegionList(const std::string& country_id) {
-    auto&& country_opt = CountryList();
-    
-    if (!country_opt)
-        return {};
-
-    nlohmann::json& country_list = country_opt->get();
-
-    try {
-        auto country_json_itr 
-            = std::find_if(country_list.begin(), country_list.end(),
-            [&](auto& country){
-                if (country.contains(YaRaspJsonPtr::kPointId)) {
-                    return country.at(YaRaspJsonPtr::kPointId).template get_ref<const std::string&>() == country_id;
-                } else {
-                    return false;
-                }
-        });
+namespace {
 
-        if (country_json_itr == country_list.end())
-            return {};
+// points without a code can not be asked for
+template<typename PointRangeType>
+YaRaspCli::PointViewList PointViews(const YaRaspPointIndex& point_index, PointLevel level, const PointRangeType& points) {
+    YaRaspCli::PointViewList point_views;
 
-        return country_json_itr->at(YaRaspJsonPtr::kRegion);
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-        return {};
+    for (uint32_t point : points) {
+        if (!point_index.GetCode(level, point).empty()) {
+            point_views.push_back(point_index.GetView(level, point));
+        }
     }
-}
 
+    return point_views;
+}
 
-std::optional<std::reference_wrapper<nlohmann::json>> 
-  YaRaspCli::CityList(const std::string& country_id, const std::string& region_id) {
-    auto&& region_opt = RegionList(country_id);
-    
-    if (!region_opt)
-        return {};
+YaRaspCli::PointViewList PointViews(const YaRaspPointIndex& point_index, PointLevel level, YaRaspPointIndex::RangeType range) {
+    return PointViews(point_index, level, std::views::iota(range.first, range.second));
+}
 
-    nlohmann::json& region_list = region_opt->get();
+} // namespace
 
-    try {
-        auto region_json_itr 
-            = std::find_if(region_list.begin(), region_list.end(),
-            [&](auto& region){
-            if (region.contains(YaRaspJsonPtr::kPointId)) {
-                return region.at(YaRaspJsonPtr::kPointId).template get_ref<const std::string&>() == region_id;
-            } else {
-                return false;
-            }
-        });
-        if (region_json_itr == region_list.end())
-            return {};
 
-        return region_json_itr->at(YaRaspJsonPtr::kCity);
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
+auto YaRaspCli::CountryList() -> std::optional<PointViewList> {
+    if (!point_index_.IsOpen())
         return {};
-    }
 
+    return PointViews(point_index_, PointLevel::COUNTRY, point_index_.All(PointLevel::COUNTRY));
 }
 
 
-std::optional<std::reference_wrapper<nlohmann::json>>
-  YaRaspCli::StationList(const std::string& country_id, const std::string& region_id, const std::string& city_id) {
-    auto&& city_opt = CityList(country_id, region_id);
-    
-    if (!city_opt)
-        return {};
-
-    nlohmann::json& city_list = city_opt->get();
+auto YaRaspCli::RegionList(const std::string& country_id) -> std::optional<PointViewList> {
+    auto country = point_index_.FindCode(PointLevel::COUNTRY, point_index_.All(PointLevel::COUNTRY), country_id);
 
-    try {
-        auto city_json_itr 
-            = std::find_if(city_list.begin(), city_list.end(),
-                [&](auto& city){
-                    if (city.contains(YaRaspJsonPtr::kPointId)) {
-                        return city.at(YaRaspJsonPtr::kPointId).template get_ref<const std::string&>() == city_id;
-                    } else {
-                        return false;
-                    }
-        
-        });
-
-        if (city_json_itr == city_list.end())
-            return {};
-
-        return city_json_itr->at(YaRaspJsonPtr::kStation);
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
+    if (!country)
         return {};
-    }
+
+    return PointViews(point_index_, PointLevel::REGION, point_index_.GetChildren(PointLevel::COUNTRY, *country));
 }
 
 
-namespace {
+auto YaRaspCli::CityList(const std::string& country_id, const std::string& region_id) -> std::optional<PointViewList> {
+    auto country = point_index_.FindCode(PointLevel::COUNTRY, point_index_.All(PointLevel::COUNTRY), country_id);
 
-template<typename RefStringType>
-std::vector<typename nlohmann::json_pointer<RefStringType>::string_t>
-    JsonPtrToVectorOfString(const nlohmann::json_pointer<RefStringType>& json_ptr) {
-    using string_type = typename nlohmann::json_pointer<RefStringType>::string_t;
+    if (!country)
+        return {};
 
-    std::vector<string_type> path_container;
-    std::stringstream ss_buff(json_ptr.to_string());
+    auto region = point_index_.FindCode(PointLevel::REGION, point_index_.GetChildren(PointLevel::COUNTRY, *country), region_id);
 
-    string_type path_buff;
-    while (std::getline(ss_buff, path_buff, '/')) {
-        path_container.push_back(path_buff);
-    }
+    if (!region)
+        return {};
 
-    return path_container;
+    return PointViews(point_index_, PointLevel::CITY, point_index_.GetChildren(PointLevel::REGION, *region));
 }
 
 
-void BuildJsonPath(nlohmann::json& json_object, const std::decay_t<decltype(json_object)>::json_pointer& path_ptr) {
-    auto path_cont = JsonPtrToVectorOfString(path_ptr);
+auto YaRaspCli::StationList(const std::string& country_id, const std::string& region_id, const std::string& city_id)
+  -> std::optional<PointViewList> {
+    auto country = point_index_.FindCode(PointLevel::COUNTRY, point_index_.All(PointLevel::COUNTRY), country_id);
 
-    if (path_cont.empty())
-        return;
+    if (!country)
+        return {};
 
-    nlohmann::json::json_pointer point_json{""};
+    auto region = point_index_.FindCode(PointLevel::REGION, point_index_.GetChildren(PointLevel::COUNTRY, *country), region_id);
 
-    for (auto&& path : std::span{path_cont.begin() + 1, path_cont.end()}) {
-        if (!json_object.contains(point_json / path)) {
-            json_object[point_json][path] = {};
-        }
-        point_json /= path;
-    }
-}
+    if (!region)
+        return {};
 
-} // namespace
+    auto city = point_index_.FindCode(PointLevel::CITY, point_index_.GetChildren(PointLevel::REGION, *region), city_id);
 
+    if (!city)
+        return {};
 
-nlohmann::json YaRaspCli::FindPointByName(const nlohmann::json& point_list, const std::string& name) {
-    nlohmann::json result_point_list = nlohmann::json::array();
+    return PointViews(point_index_, PointLevel::STATION, point_index_.GetChildren(PointLevel::CITY, *city));
+}
 
-    try {
-        for (auto& coutry : point_list) {
-            if (coutry.contains(YaRaspJsonPtr::kPointId) && coutry.contains(YaRaspJsonPtr::kPointName)) {
-                if (coutry.at(YaRaspJsonPtr::kPointName).get_ref<const std::string&>().find(name) != std::string::npos) {
-                    nlohmann::json point_json = {};
-                    
-                    BuildJsonPath(point_json, YaRaspJsonPtr::kPointId);
-                    BuildJsonPath(point_json, YaRaspJsonPtr::kPointName);
-
-                    point_json.at(YaRaspJsonPtr::kPointId) = coutry.at(YaRaspJsonPtr::kPointId);
-                    point_json.at(YaRaspJsonPtr::kPointName) = coutry.at(YaRaspJsonPtr::kPointName);
-
-                    result_point_list.push_back(point_json);
-                }
-            }
-        }
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    } catch (nlohmann::json::parse_error& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    }
 
-    return result_point_list;
+auto YaRaspCli::FindPointByName(PointLevel level, const std::string& name) -> PointViewList {
+    return PointViews(point_index_, level, point_index_.FindTitle(level, name));
 };
 
 
-nlohmann::json YaRaspCli::FindCountry(const std::string& name) {
-    try {
-        return FindPointByName(point_list_.at(YaRaspJsonPtr::kCountry), name);
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    } catch (nlohmann::json::parse_error& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    }
-    return {};
+auto YaRaspCli::FindCountry(const std::string& name) -> PointViewList {
+    return FindPointByName(PointLevel::COUNTRY, name);
 }
 
 
-nlohmann::json YaRaspCli::FindRegion(const std::string& name) {
-    nlohmann::json result = nlohmann::json::array();
-    try {
-        auto& coutries = point_list_.at(YaRaspJsonPtr::kCountry);
-        std::for_each(coutries.begin(), coutries.end(), [&](auto& coutry){
-            nlohmann::json region_list = FindPointByName(coutry.at(YaRaspJsonPtr::kRegion), name);
-            result.insert(result.end(), region_list.begin(), region_list.end());
-        });
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    } catch (nlohmann::json::parse_error& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    }
-    return result;
+auto YaRaspCli::FindRegion(const std::string& name) -> PointViewList {
+    return FindPointByName(PointLevel::REGION, name);
 }
 
 
-nlohmann::json YaRaspCli::FindCity(const std::string& name) {
-    nlohmann::json result = nlohmann::json::array();
-    try {
-        auto& coutries = point_list_.at(YaRaspJsonPtr::kCountry);
-        std::for_each(coutries.begin(), coutries.end(), [&](auto& coutry){
-            auto& regions = coutry.at(YaRaspJsonPtr::kRegion);
-            std::for_each(regions.begin(), regions.end(), [&](auto& region){
-                nlohmann::json city_list = FindPointByName(region.at(YaRaspJsonPtr::kCity), name);
-                result.insert(result.end(), city_list.begin(), city_list.end());
-            });
-        });
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    } catch (nlohmann::json::parse_error& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    }
-    return result;
+auto YaRaspCli::FindCity(const std::string& name) -> PointViewList {
+    return FindPointByName(PointLevel::CITY, name);
 }
 
 
-nlohmann::json YaRaspCli::FindStation(const std::string& name) {
-    nlohmann::json result = nlohmann::json::array();
-    try {
-        auto& coutries = point_list_.at(YaRaspJsonPtr::kCountry);
-        std::for_each(coutries.begin(), coutries.end(), [&](auto& coutry){
-            auto& regions = coutry.at(YaRaspJsonPtr::kRegion);
-            std::for_each(regions.begin(), regions.end(), [&](auto& region){
-                auto& cities = region.at(YaRaspJsonPtr::kCity);
-                std::for_each(cities.begin(), cities.end(), [&](auto& city){
-                    nlohmann::json station_list = FindPointByName(city.at(YaRaspJsonPtr::kStation), name);
-                    result.insert(result.end(), station_list.begin(), station_list.end());
-                });
-            });
-        });
-    } catch (nlohmann::json::out_of_range& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    } catch (nlohmann::json::parse_error& ex) {
-        BOOST_LOG_SEV(GetLoggerRef(), boost::log::trivial::error) << "exception id: " << ex.id << " | " << ex.what();
-    }
-    return result;
+auto YaRaspCli::FindStation(const std::string& name) -> PointViewList {
+    return FindPointByName(PointLevel::STATION, name);
 }
 
 } // namespace waybuilder
\ No newline at end of file
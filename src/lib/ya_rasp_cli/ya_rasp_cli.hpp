@@ -1,15 +1,31 @@
 #ifndef _YA_RASP_CLI_HPP_
 #define _YA_RASP_CLI_HPP_
 
+#include <chrono>
+#include <ctime>
+#include <filesystem>
 #include <initializer_list>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <cpr/cpr.h>
 #include <boost/log/sources/logger.hpp>
 
+#include "ya_rasp_scheduler.hpp"
+#include "ya_rasp_session_pool.hpp"
+#include "ya_rasp_executor.hpp"
+#include "ya_rasp_chunk_buffer.hpp"
+#include "ya_rasp_request_guard.hpp"
+#include "ya_rasp_transport.hpp"
+#include "ya_rasp_point_index.hpp"
+
 namespace waybuilder {
 
 namespace __detail {
@@ -19,35 +35,81 @@ using wjson = nlohmann::basic_json<std::map, std::vector, std::wstring>;
 } // namespace __detail
 
 
+// arguments of a ways search, empty and zero ones are not sent
+struct WaySearchParams {
+    std::string from_point;
+    std::string to_point;
+    std::string date;
+    bool transfers = false;
+    std::string transport_types;
+    std::string system;
+    std::string show_systems;
+    size_t offset = 0;
+    size_t limit = 0;
+    bool add_days_mask = false;
+    std::string result_timezone;
+};
+
+
 class YaRaspCli {
  public:
+    static constexpr size_t kDefaultCacheBudget = 32 * 1024 * 1024;
+    static constexpr std::time_t kDefaultCacheGrace = 30 * 60;
+    static constexpr size_t kDefaultWarmUpBudget = 20;
+    static constexpr size_t kDefaultPrefetchBudget = 30;
+    // stations list is tens of megabytes
+    static constexpr std::chrono::milliseconds kDefaultPointsTimeout{120000};
+    static inline const std::string kQuotaFileName = "request_quota.json";
+
+    // transport modes of the api config, record saves responses to the corpus
+    static inline const std::string kLiveTransport = "live";
+    static inline const std::string kRecordTransport = "record";
+    static inline const std::string kReplayTransport = "replay";
+    static inline const std::string kDefaultCorpusPath = "./corpus/";
+
+    // from and to point codes
+    using RouteType = std::pair<std::string, std::string>;
+    // index of the search in the batch and its response, runs on a request thread
+    using ScanWaysCallbackType = std::function<void(size_t, const cpr::Response&)>;
+    using PointViewList = std::vector<YaRaspPointView>;
+
+ public:
+    // without a transport one is made by the transport mode of the config
     YaRaspCli(const std::string& api_key, const std::string& point_list_path,
-        const std::string& api_cfg_path, const std::string& api_lang, const std::string& log_dir_path = "./logs/");
-    YaRaspCli(const std::string& api_cfg_path, const std::string& log_dir_path = "./logs/");
+        const std::string& api_cfg_path, const std::string& api_lang, const std::string& log_dir_path = "./logs/",
+        std::unique_ptr<YaRaspTransport> transport = nullptr);
+    YaRaspCli(const std::string& api_cfg_path, const std::string& log_dir_path = "./logs/",
+        std::unique_ptr<YaRaspTransport> transport = nullptr);
 
  public:
     cpr::Response ScanPoints();
     cpr::Response ScanWays(const std::string& from_point, const std::string& to_point,
         const std::string& date = "", bool transfers = false, const std::string& transport_types = "", const std::string& system = "",
         const std::string& show_systems = "", size_t offset = 0, size_t limit = 0, bool add_days_mask = false,
-        const std::string& result_timezone = "");
+        const std::string& result_timezone = "", RequestPriority priority = RequestPriority::INTERACTIVE);
+
+    // searches run concurrently on at most max_connections request threads,
+    // futures follow the order of searches, the callback is called as each completes
+    std::vector<std::future<cpr::Response>> ScanWaysAsync(const std::vector<WaySearchParams>& searches,
+        ScanWaysCallbackType callback = {}, RequestPriority priority = RequestPriority::INTERACTIVE);
 
  public:
-    std::optional<std::reference_wrapper<nlohmann::json>> CountryList();
-    std::optional<std::reference_wrapper<nlohmann::json>> RegionList(const std::string& country_id);
-    std::optional<std::reference_wrapper<nlohmann::json>>
+    // lists and finds are views into the points index, points without a code are skipped
+    std::optional<PointViewList> CountryList();
+    std::optional<PointViewList> RegionList(const std::string& country_id);
+    std::optional<PointViewList>
       CityList(const std::string& country_id, const std::string& region_id);
-    std::optional<std::reference_wrapper<nlohmann::json>>
+    std::optional<PointViewList>
       StationList(const std::string& country_id, const std::string& region_id, const std::string& city_id);
 
  private:   
-    nlohmann::json FindPointByName(const nlohmann::json& point_list, const std::string& name);
+    PointViewList FindPointByName(PointLevel level, const std::string& name);
 
  public:
-    nlohmann::json FindCountry(const std::string& name);
-    nlohmann::json FindRegion(const std::string& name);
-    nlohmann::json FindCity(const std::string& name);
-    nlohmann::json FindStation(const std::string& name);
+    PointViewList FindCountry(const std::string& name);
+    PointViewList FindRegion(const std::string& name);
+    PointViewList FindCity(const std::string& name);
+    PointViewList FindStation(const std::string& name);
   
  public:
     bool DumpCfg();
@@ -57,9 +119,18 @@ class YaRaspCli {
     bool Save();
     std::string GetLang() const { return api_lang_; };
     void SetLang(const std::string& lang) { api_lang_ = lang; };
+    size_t GetCacheBudget() const { return cache_budget_; };
+    std::time_t GetCacheGrace() const { return cache_grace_; };
+    const std::vector<RouteType>& GetWarmUpRoutes() const { return warm_up_routes_; };
+    size_t GetWarmUpBudget() const { return warm_up_budget_; };
+    size_t GetPrefetchBudget() const { return prefetch_budget_; };
+    const YaRaspRequestScheduler& GetSchedulerRef() const { return scheduler_; };
+    const YaRaspRequestGuard& GetSearchGuardRef() const { return search_guard_; };
+    const YaRaspRequestGuard& GetPointsGuardRef() const { return points_guard_; };
 
  public:
-    boost::log::sources::logger& GetLoggerRef() { return logger_; };
+    // thread safe, api requests may run on background threads
+    boost::log::sources::logger_mt& GetLoggerRef() { return logger_; };
     const std::string& GetLoggerPath() const { return log_dir_path_; };
 
  private:
@@ -67,17 +138,68 @@ class YaRaspCli {
       std::initializer_list<std::pair<std::string_view, std::string_view>> args);
 
     void LogConfigurate(const std::string& log_dir_path);
+    void SchedulerConfigurate();
+    void TransportConfigurate();
+    void GuardConfigurate();
+
+    // points index beside the points list, rebuilt when the list is newer
+    std::filesystem::path GetPointIndexPath() const;
+    // scanned list waiting for Save beside the points list
+    std::filesystem::path GetPointScanPath() const;
+    bool LoadPoints();
+    // written beside the points list file, only for a list on disk
+    bool IndexPoints(std::string index_data);
+
+    cpr::Response SearchWays(const WaySearchParams& search, const std::string& lang, RequestPriority priority);
+
+    // response of a request refused by the scheduler, status code 0
+    cpr::Response RefusedResponse(std::string_view url);
+    // response of a request not sent while the api circuit is open, status code 0
+    cpr::Response UnavailableResponse(std::string_view url);
 
  private:
-    boost::log::sources::logger logger_;
+    boost::log::sources::logger_mt logger_;
 
  private:
     std::string api_key_;
     std::string api_url_;
     std::string api_version_;
     std::string api_lang_;
-
-    nlohmann::json point_list_;
+    size_t cache_budget_ = kDefaultCacheBudget;
+    std::time_t cache_grace_ = kDefaultCacheGrace;
+    std::vector<RouteType> warm_up_routes_;
+    size_t warm_up_budget_ = kDefaultWarmUpBudget;
+    size_t prefetch_budget_ = kDefaultPrefetchBudget;
+    size_t daily_request_limit_ = YaRaspRequestScheduler::kDefaultDailyLimit;
+    double request_rate_ = YaRaspRequestScheduler::kDefaultRate;
+    size_t request_burst_ = YaRaspRequestScheduler::kDefaultBurst;
+
+    // milliseconds in the api config
+    std::chrono::milliseconds request_timeout_ = YaRaspSessionPool::kDefaultTimeout;
+    std::chrono::milliseconds connect_timeout_ = YaRaspSessionPool::kDefaultConnectTimeout;
+    std::chrono::milliseconds points_timeout_ = kDefaultPointsTimeout;
+
+    size_t request_attempts_ = YaRaspRequestGuard::kDefaultMaxAttempts;
+    bool request_hedging_ = true;
+
+    std::string transport_mode_ = kLiveTransport;
+    std::string transport_corpus_path_ = kDefaultCorpusPath;
+    bool replay_latency_ = false;
+
+    size_t max_connections_ = YaRaspRequestExecutor::kDefaultWorkerCount;
+
+    YaRaspRequestScheduler scheduler_;
+    std::unique_ptr<YaRaspTransport> transport_;
+    // hedge attempts left running use the transport
+    YaRaspRequestGuard search_guard_;
+    YaRaspRequestGuard points_guard_;
+    // made after config load, stops before the members its requests use
+    std::unique_ptr<YaRaspRequestExecutor> executor_;
+
+    // index of a scanned list, held until the list is saved,
+    // saved lists are read from the index file
+    std::optional<std::string> scanned_index_;
+    YaRaspPointIndex point_index_;
 
  private: 
     std::string api_cfg_path_;
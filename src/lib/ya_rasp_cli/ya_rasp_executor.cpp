@@ -0,0 +1,105 @@
+#include "ya_rasp_executor.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include <cpr/cpr.h>
+
+namespace waybuilder {
+
+YaRaspRequestExecutor::YaRaspRequestExecutor(size_t worker_count) {
+    workers_.reserve(worker_count);
+
+    for (size_t worker_index = 0; worker_index < worker_count; ++worker_index) {
+        workers_.emplace_back(&YaRaspRequestExecutor::WorkerLoop, this);
+    }
+}
+
+
+YaRaspRequestExecutor::~YaRaspRequestExecutor() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+
+    jobs_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+std::future<cpr::Response> YaRaspRequestExecutor::Submit(RequestFuncType request, CallbackType callback) {
+    Job job{std::move(request), std::move(callback), {}};
+    std::future<cpr::Response> response_future = job.promise.get_future();
+
+    {
+        std::lock_guard lock{mutex_};
+        jobs_.push_back(std::move(job));
+    }
+
+    jobs_cv_.notify_one();
+    return response_future;
+}
+
+
+std::optional<std::future<cpr::Response>> YaRaspRequestExecutor::TrySubmit(RequestFuncType request) {
+    Job job{std::move(request), {}, {}};
+    std::future<cpr::Response> response_future = job.promise.get_future();
+
+    {
+        std::lock_guard lock{mutex_};
+
+        // every queued request already has an idle worker waking for it
+        if (stop_ || idle_count_ <= jobs_.size()) {
+            return {};
+        }
+
+        jobs_.push_back(std::move(job));
+    }
+
+    jobs_cv_.notify_one();
+    return response_future;
+}
+
+
+void YaRaspRequestExecutor::WorkerLoop() {
+    std::unique_lock lock{mutex_};
+
+    while (true) {
+        ++idle_count_;
+        jobs_cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+        --idle_count_;
+
+        // queued requests are still sent, their futures must become ready
+        if (jobs_.empty()) {
+            return;
+        }
+
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        lock.unlock();
+
+        try {
+            cpr::Response resp = job.request();
+
+            if (job.callback) {
+                job.callback(resp);
+            }
+
+            job.promise.set_value(std::move(resp));
+        } catch (...) {
+            job.promise.set_exception(std::current_exception());
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace waybuilder
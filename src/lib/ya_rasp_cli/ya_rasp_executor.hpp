@@ -0,0 +1,67 @@
+#ifndef _YA_RASP_EXECUTOR_HPP_
+#define _YA_RASP_EXECUTOR_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+namespace waybuilder {
+
+// Fixed pool of request threads: at most worker_count requests are in flight,
+// so with pooled keep-alive sessions the number of connections is bounded.
+// Requests run in submit order, the callback of a request runs on its worker
+// thread right after the response, before the future is ready.
+class YaRaspRequestExecutor {
+ public:
+    using RequestFuncType = std::function<cpr::Response()>;
+    using CallbackType = std::function<void(const cpr::Response&)>;
+
+    static constexpr size_t kDefaultWorkerCount = 4;
+
+ public:
+    explicit YaRaspRequestExecutor(size_t worker_count = kDefaultWorkerCount);
+    ~YaRaspRequestExecutor();
+
+    YaRaspRequestExecutor(const YaRaspRequestExecutor&) = delete;
+    YaRaspRequestExecutor& operator=(const YaRaspRequestExecutor&) = delete;
+
+ public:
+    std::future<cpr::Response> Submit(RequestFuncType request, CallbackType callback = {});
+    // taken only if an idle worker starts it at once, never queued
+    // behind the requests of busy workers
+    std::optional<std::future<cpr::Response>> TrySubmit(RequestFuncType request);
+
+ public:
+    size_t GetWorkerCount() const { return workers_.size(); };
+
+ private:
+    struct Job {
+        RequestFuncType request;
+        CallbackType callback;
+        std::promise<cpr::Response> promise;
+    };
+
+ private:
+    void WorkerLoop();
+
+ private:
+    std::mutex mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Job> jobs_;
+    size_t idle_count_ = 0;
+    bool stop_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_EXECUTOR_HPP_
@@ -9,6 +9,23 @@ const nlohmann::json::json_pointer YaRaspJsonPtr::kPointListPath{"/point_list_pa
 const nlohmann::json::json_pointer YaRaspJsonPtr::kApiUrl{"/api_url"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kApiVersion{"/api_version"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kApiLang{"/api_lang"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kCacheBudget{"/cache_budget"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kCacheGrace{"/cache_grace"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kWarmUpRoutes{"/warm_up_routes"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kWarmUpBudget{"/warm_up_budget"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kPrefetchBudget{"/prefetch_budget"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kDailyRequestLimit{"/daily_request_limit"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestRate{"/request_rate"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestBurst{"/request_burst"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestTimeout{"/request_timeout_ms"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kConnectTimeout{"/connect_timeout_ms"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kMaxConnections{"/max_connections"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kPointsTimeout{"/points_timeout_ms"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestAttempts{"/request_attempts"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestHedging{"/request_hedging"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kTransport{"/transport"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kTransportCorpus{"/transport_corpus"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kReplayLatency{"/replay_latency"};
 
 const nlohmann::json::json_pointer YaRaspJsonPtr::kCountry{"/countries"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kRegion{"/regions"};
@@ -21,6 +38,8 @@ const nlohmann::json::json_pointer YaRaspJsonPtr::kPointName{"/title"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kStationType{"/station_type"};
 
 const nlohmann::json::json_pointer YaRaspJsonPtr::kResultCount{"/pagination/total"}; 
+const nlohmann::json::json_pointer YaRaspJsonPtr::kResultLimit{"/pagination/limit"};
+const nlohmann::json::json_pointer YaRaspJsonPtr::kResultOffset{"/pagination/offset"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestFromPointName{"/search/from/popular_title"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestToPointName{"/search/to/popular_title"};
 const nlohmann::json::json_pointer YaRaspJsonPtr::kRequestDate{"/search/date"};
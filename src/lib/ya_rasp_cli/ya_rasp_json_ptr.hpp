@@ -18,6 +18,8 @@ struct YaRaspJsonPtr {
 
  public:
     static const nlohmann::json::json_pointer kResultCount;
+    static const nlohmann::json::json_pointer kResultLimit;
+    static const nlohmann::json::json_pointer kResultOffset;
     static const nlohmann::json::json_pointer kRequestFromPointName;
     static const nlohmann::json::json_pointer kRequestToPointName;
     static const nlohmann::json::json_pointer kRequestDate;
@@ -41,6 +43,23 @@ struct YaRaspJsonPtr {
     static const nlohmann::json::json_pointer kApiUrl;
     static const nlohmann::json::json_pointer kApiVersion;
     static const nlohmann::json::json_pointer kApiLang;
+    static const nlohmann::json::json_pointer kCacheBudget;
+    static const nlohmann::json::json_pointer kCacheGrace;
+    static const nlohmann::json::json_pointer kWarmUpRoutes;
+    static const nlohmann::json::json_pointer kWarmUpBudget;
+    static const nlohmann::json::json_pointer kPrefetchBudget;
+    static const nlohmann::json::json_pointer kDailyRequestLimit;
+    static const nlohmann::json::json_pointer kRequestRate;
+    static const nlohmann::json::json_pointer kRequestBurst;
+    static const nlohmann::json::json_pointer kRequestTimeout;
+    static const nlohmann::json::json_pointer kConnectTimeout;
+    static const nlohmann::json::json_pointer kMaxConnections;
+    static const nlohmann::json::json_pointer kPointsTimeout;
+    static const nlohmann::json::json_pointer kRequestAttempts;
+    static const nlohmann::json::json_pointer kRequestHedging;
+    static const nlohmann::json::json_pointer kTransport;
+    static const nlohmann::json::json_pointer kTransportCorpus;
+    static const nlohmann::json::json_pointer kReplayLatency;
 
  private:
     static const nlohmann::json::json_pointer kCountry;
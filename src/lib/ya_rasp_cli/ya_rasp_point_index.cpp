@@ -0,0 +1,457 @@
+#include "ya_rasp_point_index.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+namespace {
+
+// children of a point by level, stations have none
+const std::array<std::string, YaRaspPointIndex::kLevelCount - 1> kChildKeys = {"regions", "settlements", "stations"};
+
+void AppendArray(std::string& index_data, const std::vector<uint32_t>& values) {
+    index_data.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint32_t));
+}
+
+// count offsets, none decreasing and none past the bound
+bool IsMonotonic(const uint32_t* offsets, size_t count, uint32_t bound) {
+    for (size_t index = 0; index < count; ++index) {
+        if (offsets[index] > bound || (index > 0 && offsets[index] < offsets[index - 1])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+// SAX handler of the api points list: a point is appended to its level as
+// soon as its object opens, code and title are filled in when read, so the
+// list is never held as a document. Points come depth first, the children
+// of a point are the next ones of the level below and stay contiguous.
+class YaRaspPointIndex::ListReader {
+ public:
+    bool null() { return true; };
+    bool boolean(bool) { return true; };
+    bool number_integer(nlohmann::json::number_integer_t) { return true; };
+    bool number_unsigned(nlohmann::json::number_unsigned_t) { return true; };
+    bool number_float(nlohmann::json::number_float_t, const std::string&) { return true; };
+    bool binary(nlohmann::json::binary_t&) { return true; };
+    bool string(std::string& value);
+
+    bool start_object(size_t) { return Open(true); };
+    bool end_object() { return Close(); };
+    bool start_array(size_t) { return Open(false); };
+    bool end_array() { return Close(); };
+    bool key(std::string& key);
+
+    bool parse_error(size_t, const std::string&, const nlohmann::json::exception&) { return false; };
+
+ public:
+    // index bytes of the points read
+    std::string Finish();
+
+ private:
+    // what an open object or array of the list is
+    enum class Node { ROOT, POINTS, POINT, CODES, OTHER };
+
+    struct Frame {
+        Node node;
+        size_t level;
+        // last key of an object
+        std::string key;
+    };
+
+    struct LevelData {
+        std::vector<std::string> codes;
+        std::vector<std::string> titles;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> child_offsets;
+    };
+
+ private:
+    bool Open(bool is_object);
+    bool Close();
+    void AddPoint(size_t level);
+
+ private:
+    std::vector<Frame> frames_;
+    std::array<LevelData, kLevelCount> levels_;
+};
+
+
+bool YaRaspPointIndex::ListReader::string(std::string& value) {
+    if (frames_.empty()) {
+        return true;
+    }
+
+    const Frame& frame = frames_.back();
+
+    if (frame.node == Node::POINT && frame.key == "title") {
+        levels_[frame.level].titles.back() = std::move(value);
+    } else if (frame.node == Node::CODES && frame.key == "yandex_code") {
+        levels_[frame.level].codes.back() = std::move(value);
+    }
+
+    return true;
+}
+
+
+bool YaRaspPointIndex::ListReader::key(std::string& key) {
+    frames_.back().key = std::move(key);
+    return true;
+}
+
+
+bool YaRaspPointIndex::ListReader::Open(bool is_object) {
+    Frame frame{Node::OTHER, 0, {}};
+
+    if (frames_.empty()) {
+        frame.node = is_object ? Node::ROOT : Node::OTHER;
+    } else if (const Frame& parent = frames_.back(); !is_object && parent.node == Node::ROOT && parent.key == "countries") {
+        frame.node = Node::POINTS;
+    } else if (!is_object && parent.node == Node::POINT && parent.level + 1 < kLevelCount && parent.key == kChildKeys[parent.level]) {
+        frame = {Node::POINTS, parent.level + 1, {}};
+    } else if (is_object && parent.node == Node::POINTS) {
+        frame = {Node::POINT, parent.level, {}};
+        AddPoint(parent.level);
+    } else if (is_object && parent.node == Node::POINT && parent.key == "codes") {
+        frame = {Node::CODES, parent.level, {}};
+    }
+
+    frames_.push_back(std::move(frame));
+    return true;
+}
+
+
+bool YaRaspPointIndex::ListReader::Close() {
+    frames_.pop_back();
+    return true;
+}
+
+
+void YaRaspPointIndex::ListReader::AddPoint(size_t level) {
+    LevelData& level_data = levels_[level];
+
+    level_data.codes.emplace_back();
+    level_data.titles.emplace_back();
+    // the parent is the open point of the level above, the last one read
+    level_data.parents.push_back(level == 0 ? kNoParent : static_cast<uint32_t>(levels_[level - 1].codes.size() - 1));
+
+    if (level + 1 < kLevelCount) {
+        level_data.child_offsets.push_back(static_cast<uint32_t>(levels_[level + 1].codes.size()));
+    }
+}
+
+
+std::string YaRaspPointIndex::ListReader::Finish() {
+    for (size_t level = 0; level + 1 < kLevelCount; ++level) {
+        levels_[level].child_offsets.push_back(static_cast<uint32_t>(levels_[level + 1].codes.size()));
+    }
+
+    levels_.back().child_offsets.assign(levels_.back().codes.size() + 1, 0);
+
+    std::string pool;
+    std::array<std::vector<uint32_t>, kLevelCount> code_offsets;
+    std::array<std::vector<uint32_t>, kLevelCount> title_offsets;
+
+    for (size_t level = 0; level < kLevelCount; ++level) {
+        for (const auto& code : levels_[level].codes) {
+            code_offsets[level].push_back(static_cast<uint32_t>(pool.size()));
+            pool += code;
+        }
+        code_offsets[level].push_back(static_cast<uint32_t>(pool.size()));
+
+        for (const auto& title : levels_[level].titles) {
+            title_offsets[level].push_back(static_cast<uint32_t>(pool.size()));
+            pool += title;
+        }
+        title_offsets[level].push_back(static_cast<uint32_t>(pool.size()));
+    }
+
+    Header header{kMagic, kVersion, {}, static_cast<uint32_t>(pool.size())};
+    for (size_t level = 0; level < kLevelCount; ++level) {
+        header.sizes[level] = static_cast<uint32_t>(levels_[level].codes.size());
+    }
+
+    std::string index_data(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (size_t level = 0; level < kLevelCount; ++level) {
+        AppendArray(index_data, code_offsets[level]);
+        AppendArray(index_data, title_offsets[level]);
+        AppendArray(index_data, levels_[level].parents);
+        AppendArray(index_data, levels_[level].child_offsets);
+    }
+
+    index_data += pool;
+    return index_data;
+}
+
+
+std::optional<std::string> YaRaspPointIndex::Build(std::istream& point_list) {
+    ListReader reader;
+
+    if (!nlohmann::json::sax_parse(point_list, &reader)) {
+        return {};
+    }
+
+    return reader.Finish();
+}
+
+
+bool YaRaspPointIndex::Save(const std::string& index_data, const std::filesystem::path& index_path) {
+    std::filesystem::path temp_path = index_path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream index_file{temp_path, std::ios::binary | std::ios::trunc};
+        index_file.write(index_data.data(), static_cast<std::streamsize>(index_data.size()));
+
+        if (!index_file) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, index_path, ec);
+    return !ec;
+}
+
+
+bool YaRaspPointIndex::Open(const std::filesystem::path& index_path) {
+    Close();
+
+    try {
+        file_mapping_ = boost::interprocess::file_mapping{index_path.c_str(), boost::interprocess::read_only};
+        mapped_region_ = boost::interprocess::mapped_region{file_mapping_, boost::interprocess::read_only};
+    } catch (const boost::interprocess::interprocess_exception&) {
+        Close();
+        return false;
+    }
+
+    if (!Attach(static_cast<const char*>(mapped_region_.get_address()), mapped_region_.get_size())) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool YaRaspPointIndex::Assign(std::string index_data) {
+    Close();
+
+    owned_data_ = std::move(index_data);
+
+    if (!Attach(owned_data_.data(), owned_data_.size())) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+std::string_view YaRaspPointIndex::GetCode(PointLevel level, uint32_t point) const {
+    const Level& index_level = levels_[Index(level)];
+    return {pool_ + index_level.code_offsets[point], index_level.code_offsets[point + 1] - index_level.code_offsets[point]};
+}
+
+
+std::string_view YaRaspPointIndex::GetTitle(PointLevel level, uint32_t point) const {
+    const Level& index_level = levels_[Index(level)];
+    return {pool_ + index_level.title_offsets[point], index_level.title_offsets[point + 1] - index_level.title_offsets[point]};
+}
+
+
+auto YaRaspPointIndex::GetChildren(PointLevel level, uint32_t point) const -> RangeType {
+    const Level& index_level = levels_[Index(level)];
+    return {index_level.child_offsets[point], index_level.child_offsets[point + 1]};
+}
+
+
+auto YaRaspPointIndex::Find(std::string_view code) const -> std::optional<PointRef> {
+    if (!is_open_) {
+        return {};
+    }
+
+    if (!is_hashed_) {
+        HashCodes();
+    }
+
+    if (auto point_it = code_points_.find(code); point_it != code_points_.end()) {
+        return point_it->second;
+    }
+
+    return {};
+}
+
+
+std::optional<uint32_t> YaRaspPointIndex::FindCode(PointLevel level, RangeType range, std::string_view code) const {
+    if (!is_open_ || code.empty()) {
+        return {};
+    }
+
+    auto point_ref = Find(code);
+
+    if (!point_ref) {
+        return {};
+    }
+
+    if (point_ref->level == level && range.first <= point_ref->point && point_ref->point < range.second) {
+        return point_ref->point;
+    }
+
+    for (uint32_t point = range.first; point < range.second; ++point) {
+        if (GetCode(level, point) == code) {
+            return point;
+        }
+    }
+
+    return {};
+}
+
+
+std::vector<uint32_t> YaRaspPointIndex::FindTitle(PointLevel level, std::string_view part) const {
+    if (!is_open_) {
+        return {};
+    }
+
+    if (!is_title_indexed_[Index(level)]) {
+        IndexTitles(level);
+    }
+
+    return title_grams_[Index(level)].Search(part, [this, level](uint32_t point) { return GetTitle(level, point); });
+}
+
+
+bool YaRaspPointIndex::Attach(const char* data, size_t size) {
+    Header header;
+
+    if (size < sizeof(header)) {
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.magic != kMagic || header.version != kVersion) {
+        return false;
+    }
+
+    // the arrays of all levels, then the pool, fill the data exactly
+    size_t expected_size = sizeof(header);
+    for (uint32_t level_size : header.sizes) {
+        expected_size += (4 * static_cast<size_t>(level_size) + 3) * sizeof(uint32_t);
+    }
+    expected_size += header.pool_size;
+
+    if (expected_size != size) {
+        return false;
+    }
+
+    const uint32_t* values = reinterpret_cast<const uint32_t*>(data + sizeof(header));
+
+    for (size_t level = 0; level < kLevelCount; ++level) {
+        Level& index_level = levels_[level];
+        index_level.size = header.sizes[level];
+
+        index_level.code_offsets = values;
+        values += index_level.size + 1;
+        index_level.title_offsets = values;
+        values += index_level.size + 1;
+        index_level.parents = values;
+        values += index_level.size;
+        index_level.child_offsets = values;
+        values += index_level.size + 1;
+
+        // a damaged file must not send a view out of the data
+        const uint32_t child_count = level + 1 < kLevelCount ? header.sizes[level + 1] : 0;
+        if (!IsMonotonic(index_level.code_offsets, index_level.size + 1, header.pool_size)
+          || !IsMonotonic(index_level.title_offsets, index_level.size + 1, header.pool_size)
+          || !IsMonotonic(index_level.child_offsets, index_level.size + 1, child_count)) {
+            return false;
+        }
+
+        // countries have no parent, the rest have one in the level above
+        for (uint32_t point = 0; point < index_level.size; ++point) {
+            const uint32_t parent = index_level.parents[point];
+
+            if (level == 0 ? parent != kNoParent : parent >= header.sizes[level - 1]) {
+                return false;
+            }
+        }
+    }
+
+    pool_ = reinterpret_cast<const char*>(values);
+    is_open_ = true;
+
+    return true;
+}
+
+
+void YaRaspPointIndex::HashCodes() const {
+    size_t point_count = 0;
+    for (const auto& index_level : levels_) {
+        point_count += index_level.size;
+    }
+
+    code_points_.reserve(point_count);
+
+    for (size_t level = 0; level < kLevelCount; ++level) {
+        for (uint32_t point = 0; point < levels_[level].size; ++point) {
+            const std::string_view code = GetCode(static_cast<PointLevel>(level), point);
+
+            if (!code.empty()) {
+                code_points_.try_emplace(code, PointRef{static_cast<PointLevel>(level), point});
+            }
+        }
+    }
+
+    is_hashed_ = true;
+}
+
+
+void YaRaspPointIndex::IndexTitles(PointLevel level) const {
+    title_grams_[Index(level)].Build(Size(level), [this, level](uint32_t point) { return GetTitle(level, point); });
+    is_title_indexed_[Index(level)] = true;
+}
+
+
+void YaRaspPointIndex::Close() {
+    code_points_.clear();
+    is_hashed_ = false;
+    for (auto& level_grams : title_grams_) {
+        level_grams.Clear();
+    }
+    is_title_indexed_ = {};
+    levels_ = {};
+    pool_ = nullptr;
+    is_open_ = false;
+
+    mapped_region_ = boost::interprocess::mapped_region{};
+    file_mapping_ = boost::interprocess::file_mapping{};
+    owned_data_.clear();
+}
+
+} // namespace waybuilder
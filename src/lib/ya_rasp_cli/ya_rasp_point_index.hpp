@@ -0,0 +1,144 @@
+#ifndef _YA_RASP_POINT_INDEX_HPP_
+#define _YA_RASP_POINT_INDEX_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "ya_rasp_trigram_index.hpp"
+
+namespace waybuilder {
+
+enum class PointLevel : uint32_t { COUNTRY, REGION, CITY, STATION };
+
+// code and title of a point, views into the index valid until the points are rescanned
+struct YaRaspPointView {
+    std::string_view code;
+    std::string_view title;
+};
+
+
+// Binary index of the points list, read in place from a memory mapped file
+// instead of parsing the whole list json on start. Each level is a flat
+// struct of arrays: code and title offsets into one string pool, the parent
+// index in the level above and the range of children in the level below.
+// Children of a point are contiguous, so a list is a range of the next level.
+// Codes of all levels are hashed on the first code lookup, a point is found
+// by its code in constant time. Titles of a level get a trigram index on the
+// first title lookup of the level, a point is found by a part of its title
+// without a scan of the level. Opening the index only checks its layout.
+// Lookups are made from the command thread only, the lazy builds are not locked.
+//
+// layout: header, then per level code offsets [n + 1], title offsets [n + 1],
+// parents [n], child offsets [n + 1], then the string pool; all uint32
+class YaRaspPointIndex {
+ public:
+    static constexpr size_t kLevelCount = 4;
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+    static inline const std::string kIndexExtension = ".pidx";
+
+    // [begin, end) indexes of a level
+    using RangeType = std::pair<uint32_t, uint32_t>;
+
+    struct PointRef {
+        PointLevel level;
+        uint32_t point;
+    };
+
+ public:
+    YaRaspPointIndex() = default;
+
+    YaRaspPointIndex(const YaRaspPointIndex&) = delete;
+    YaRaspPointIndex& operator=(const YaRaspPointIndex&) = delete;
+
+ public:
+    // index bytes of the api points list json read from the stream,
+    // empty for a malformed list
+    static std::optional<std::string> Build(std::istream& point_list);
+    // written aside and renamed, a mapped index of the same path stays valid
+    static bool Save(const std::string& index_data, const std::filesystem::path& index_path);
+
+    bool Open(const std::filesystem::path& index_path);
+    // index kept in memory, when it can not be saved
+    bool Assign(std::string index_data);
+
+ public:
+    bool IsOpen() const { return is_open_; };
+
+    uint32_t Size(PointLevel level) const { return levels_[Index(level)].size; };
+    RangeType All(PointLevel level) const { return {0, Size(level)}; };
+
+    std::string_view GetCode(PointLevel level, uint32_t point) const;
+    std::string_view GetTitle(PointLevel level, uint32_t point) const;
+    YaRaspPointView GetView(PointLevel level, uint32_t point) const { return {GetCode(level, point), GetTitle(level, point)}; };
+    uint32_t GetParent(PointLevel level, uint32_t point) const { return levels_[Index(level)].parents[point]; };
+    // range of the level below, empty for stations
+    RangeType GetChildren(PointLevel level, uint32_t point) const;
+
+    std::optional<PointRef> Find(std::string_view code) const;
+    // point of the level inside the range, a code repeated in the list is
+    // looked up through the range
+    std::optional<uint32_t> FindCode(PointLevel level, RangeType range, std::string_view code) const;
+    // points of the level with the part in the title, in index order
+    std::vector<uint32_t> FindTitle(PointLevel level, std::string_view part) const;
+
+ private:
+    struct Header {
+        std::array<char, 4> magic;
+        uint32_t version;
+        std::array<uint32_t, kLevelCount> sizes;
+        uint32_t pool_size;
+    };
+
+    struct Level {
+        uint32_t size = 0;
+        const uint32_t* code_offsets = nullptr;
+        const uint32_t* title_offsets = nullptr;
+        const uint32_t* parents = nullptr;
+        const uint32_t* child_offsets = nullptr;
+    };
+
+    static constexpr std::array<char, 4> kMagic = {'W', 'B', 'P', 'I'};
+    static constexpr uint32_t kVersion = 1;
+
+    class ListReader;
+
+ private:
+    static size_t Index(PointLevel level) { return static_cast<size_t>(level); };
+
+    // checks the layout and points the levels into data
+    bool Attach(const char* data, size_t size);
+    // built once, on the first lookup
+    void HashCodes() const;
+    void IndexTitles(PointLevel level) const;
+    void Close();
+
+ private:
+    boost::interprocess::file_mapping file_mapping_;
+    boost::interprocess::mapped_region mapped_region_;
+    std::string owned_data_;
+
+    std::array<Level, kLevelCount> levels_;
+    const char* pool_ = nullptr;
+    // views into the pool, the first point of a repeated code
+    mutable std::unordered_map<std::string_view, PointRef> code_points_;
+    mutable std::array<YaRaspTrigramIndex, kLevelCount> title_grams_;
+    mutable bool is_hashed_ = false;
+    mutable std::array<bool, kLevelCount> is_title_indexed_{};
+    bool is_open_ = false;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_POINT_INDEX_HPP_
@@ -0,0 +1,367 @@
+#include "ya_rasp_request_guard.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+#include "ya_rasp_executor.hpp"
+
+namespace waybuilder {
+
+struct YaRaspRequestGuard::Race {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+
+    // a good answer of the hedge while the first attempt runs or after it failed
+    std::optional<cpr::Response> hedge_winner;
+    bool is_primary_done = false;
+    bool is_primary_failed = false;
+    bool is_hedge_running = false;
+
+    // the first attempt still needs the hedge
+    bool IsHedgeWanted() const { return !is_primary_done || is_primary_failed; };
+};
+
+
+YaRaspRequestGuard::~YaRaspRequestGuard() {
+    {
+        std::lock_guard lock{mutex_};
+        is_stopping_ = true;
+    }
+
+    hedges_cv_.notify_all();
+
+    if (hedge_timer_.joinable()) {
+        hedge_timer_.join();
+    }
+
+    // a losing hedge on the executor still records into the guard
+    std::unique_lock lock{mutex_};
+    races_cv_.wait(lock, [this]() { return running_attempt_count_ == 0; });
+}
+
+
+void YaRaspRequestGuard::Configure(size_t max_attempts, bool hedging, YaRaspRequestExecutor* executor) {
+    std::lock_guard lock{mutex_};
+
+    max_attempts_ = std::max<size_t>(max_attempts, 1);
+    hedging_ = hedging;
+    executor_ = executor;
+}
+
+
+bool YaRaspRequestGuard::Allow() {
+    std::lock_guard lock{mutex_};
+
+    if (failure_count_ < kFailureThreshold) {
+        return true;
+    }
+
+    // half open: one probe passes and the circuit stays open for the rest,
+    // a probe lost without an answer is followed by another after kOpenTime
+    if (const auto now = ClockType::now(); now >= open_until_) {
+        open_until_ = now + kOpenTime;
+        return true;
+    }
+
+    ++stats_.fast_failures;
+    return false;
+}
+
+
+cpr::Response YaRaspRequestGuard::Run(const AttemptFuncType& attempt, const AdmitFuncType& admit) {
+    size_t max_attempts = 0;
+    {
+        std::lock_guard lock{mutex_};
+        max_attempts = max_attempts_;
+    }
+
+    cpr::Response resp;
+
+    for (size_t attempt_index = 0; attempt_index < max_attempts; ++attempt_index) {
+        if (attempt_index > 0) {
+            std::this_thread::sleep_for(Backoff(attempt_index - 1));
+
+            // a retry while the circuit is open would only add load
+            if (IsOpen() || !admit()) {
+                break;
+            }
+
+            std::lock_guard lock{mutex_};
+            ++stats_.retries;
+        }
+
+        resp = RunHedged(attempt, admit);
+
+        if (!IsRetryable(resp)) {
+            break;
+        }
+    }
+
+    return resp;
+}
+
+
+bool YaRaspRequestGuard::IsOpen() const {
+    std::lock_guard lock{mutex_};
+    return failure_count_ >= kFailureThreshold && ClockType::now() < open_until_;
+}
+
+
+auto YaRaspRequestGuard::GetStats() const -> Stats {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+
+bool YaRaspRequestGuard::IsRetryable(const cpr::Response& resp) {
+    // timeouts and broken connections, a body may be cut after the status
+    if (resp.error) {
+        return true;
+    }
+
+    return resp.status_code == 429 || resp.status_code == 500 || resp.status_code == 502
+        || resp.status_code == 503 || resp.status_code == 504;
+}
+
+
+cpr::Response YaRaspRequestGuard::RunHedged(const AttemptFuncType& attempt, const AdmitFuncType& admit) {
+    const auto hedge_delay = HedgeDelay();
+
+    YaRaspRequestExecutor* executor = nullptr;
+    {
+        std::lock_guard lock{mutex_};
+        executor = executor_;
+    }
+
+    std::shared_ptr<Race> race;
+
+    if (hedge_delay && executor) {
+        race = std::make_shared<Race>();
+        ScheduleHedge(ClockType::now() + *hedge_delay, MakeHedgeLaunch(race, executor, attempt, admit));
+    }
+
+    // the first attempt holds no worker but the caller's own
+    const auto start_time = ClockType::now();
+    std::optional<cpr::Response> resp;
+
+    try {
+        resp = attempt();
+    } catch (...) {
+        if (race) {
+            std::lock_guard race_lock{race->mutex};
+            race->is_primary_done = true;
+        }
+        throw;
+    }
+
+    Record(*resp, ClockType::now() - start_time);
+
+    if (!race) {
+        return std::move(*resp);
+    }
+
+    std::unique_lock race_lock{race->mutex};
+    race->is_primary_done = true;
+    race->is_primary_failed = IsRetryable(*resp);
+
+    // a failed first attempt waits for a running hedge instead of a retry
+    if (race->is_primary_failed) {
+        race->done_cv.wait(race_lock, [&race]() { return !race->is_hedge_running; });
+    }
+
+    if (!race->hedge_winner) {
+        return std::move(*resp);
+    }
+
+    std::lock_guard lock{mutex_};
+    ++stats_.hedge_wins;
+
+    return std::move(*race->hedge_winner);
+}
+
+
+auto YaRaspRequestGuard::MakeHedgeLaunch(std::shared_ptr<Race> race, YaRaspRequestExecutor* executor,
+    AttemptFuncType attempt, AdmitFuncType admit) -> std::function<void()> {
+    // the hedge is admitted on its worker, unless the first attempt is already good;
+    // it may finish after the request returned, the attempt functions are copied
+    auto hedge = [this, race, attempt = std::move(attempt), admit = std::move(admit)]() {
+        bool is_sent = false;
+        {
+            std::lock_guard race_lock{race->mutex};
+            is_sent = race->IsHedgeWanted();
+        }
+
+        is_sent = is_sent && admit();
+        std::optional<cpr::Response> resp;
+
+        if (is_sent) {
+            {
+                std::lock_guard lock{mutex_};
+                ++stats_.hedges;
+            }
+
+            const auto start_time = ClockType::now();
+
+            try {
+                resp = attempt();
+            } catch (const std::exception&) {
+                resp.emplace().status_code = 0;
+            }
+
+            Record(*resp, ClockType::now() - start_time);
+        }
+
+        {
+            std::lock_guard race_lock{race->mutex};
+            race->is_hedge_running = false;
+
+            // an answer after a good first attempt is dropped
+            if (resp && race->IsHedgeWanted() && !IsRetryable(*resp)) {
+                race->hedge_winner = std::move(*resp);
+            }
+        }
+        race->done_cv.notify_all();
+
+        // notified under the lock, the guard may be destroyed right after
+        std::lock_guard lock{mutex_};
+        --running_attempt_count_;
+        races_cv_.notify_all();
+
+        return cpr::Response{};
+    };
+
+    // runs on the hedge timer once the delay has passed
+    return [this, race, executor, hedge = std::move(hedge)]() {
+        {
+            std::lock_guard race_lock{race->mutex};
+
+            if (race->is_primary_done) {
+                return;
+            }
+
+            race->is_hedge_running = true;
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            ++running_attempt_count_;
+        }
+
+        if (executor->TrySubmit(hedge)) {
+            return;
+        }
+
+        // no idle worker for a duplicate, the request is not hedged
+        {
+            std::lock_guard race_lock{race->mutex};
+            race->is_hedge_running = false;
+        }
+        race->done_cv.notify_all();
+
+        std::lock_guard lock{mutex_};
+        --running_attempt_count_;
+        races_cv_.notify_all();
+    };
+}
+
+
+void YaRaspRequestGuard::ScheduleHedge(ClockType::time_point hedge_time, std::function<void()> launch) {
+    {
+        std::lock_guard lock{mutex_};
+
+        // started by the first hedged request, a guard without hedging has no timer
+        if (!hedge_timer_.joinable()) {
+            hedge_timer_ = std::thread{&YaRaspRequestGuard::HedgeTimerLoop, this};
+        }
+
+        pending_hedges_.emplace(hedge_time, std::move(launch));
+    }
+
+    hedges_cv_.notify_one();
+}
+
+
+void YaRaspRequestGuard::HedgeTimerLoop() {
+    std::unique_lock lock{mutex_};
+
+    while (!is_stopping_) {
+        if (pending_hedges_.empty()) {
+            hedges_cv_.wait(lock);
+            continue;
+        }
+
+        auto hedge_it = pending_hedges_.begin();
+
+        if (ClockType::now() < hedge_it->first) {
+            hedges_cv_.wait_until(lock, hedge_it->first);
+            continue;
+        }
+
+        std::function<void()> launch = std::move(hedge_it->second);
+        pending_hedges_.erase(hedge_it);
+
+        lock.unlock();
+        launch();
+        lock.lock();
+    }
+}
+
+
+std::chrono::milliseconds YaRaspRequestGuard::Backoff(size_t retry_index) {
+    const auto ceiling = std::min(kMaxBackoff, kBaseBackoff * (1 << std::min<size_t>(retry_index, 16)));
+
+    std::lock_guard lock{mutex_};
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution{0, ceiling.count()};
+
+    return std::chrono::milliseconds{distribution(random_)};
+}
+
+
+std::optional<std::chrono::milliseconds> YaRaspRequestGuard::HedgeDelay() const {
+    std::lock_guard lock{mutex_};
+
+    if (!hedging_ || latencies_.size() < kMinLatencySamples) {
+        return {};
+    }
+
+    std::vector<std::chrono::milliseconds> latencies{latencies_.begin(), latencies_.end()};
+    auto percentile_it = latencies.begin() + static_cast<ptrdiff_t>(kHedgePercentile * (latencies.size() - 1));
+    std::nth_element(latencies.begin(), percentile_it, latencies.end());
+
+    return *percentile_it;
+}
+
+
+void YaRaspRequestGuard::Record(const cpr::Response& resp, ClockType::duration latency) {
+    std::lock_guard lock{mutex_};
+
+    if (IsRetryable(resp)) {
+        if (++failure_count_ >= kFailureThreshold) {
+            open_until_ = ClockType::now() + kOpenTime;
+        }
+        return;
+    }
+
+    // client errors mean the api is up
+    failure_count_ = 0;
+
+    latencies_.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(latency));
+
+    if (latencies_.size() > kLatencyWindowSize) {
+        latencies_.pop_front();
+    }
+}
+
+} // namespace waybuilder
@@ -0,0 +1,126 @@
+#ifndef _YA_RASP_REQUEST_GUARD_HPP_
+#define _YA_RASP_REQUEST_GUARD_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+
+#include <cpr/cpr.h>
+
+#include "ya_rasp_executor.hpp"
+
+namespace waybuilder {
+
+// Resilience of the requests to one api endpoint.
+// Retries: transport errors, 429 and 5xx responses are retried with
+// exponential backoff and full jitter, up to max_attempts attempts.
+// Hedging: once an attempt runs longer than the latency percentile of recent
+// successful requests, a duplicate is sent and the first good response wins.
+// The first attempt runs on the calling thread. The hedge is handed to an
+// idle worker of the request executor by a timer thread once the delay has
+// passed, so a request holds a second worker only while its hedge runs and
+// a busy executor gets no hedges. The caller returns when its own attempt is
+// done; a hedge that answered first is taken, and when the first attempt
+// fails, a running hedge is waited for instead of a retry.
+// Circuit breaker: after kFailureThreshold failed requests in a row requests
+// fail fast for kOpenTime, then a single probe passes while the rest still
+// fail fast; its success closes the circuit, its failure opens it again.
+// Retries and hedges pass the admit function first, it charges the quota.
+class YaRaspRequestGuard {
+ public:
+    using AttemptFuncType = std::function<cpr::Response()>;
+    using AdmitFuncType = std::function<bool()>;
+
+    static constexpr size_t kDefaultMaxAttempts = 3;
+    static constexpr std::chrono::milliseconds kBaseBackoff{200};
+    static constexpr std::chrono::milliseconds kMaxBackoff{3000};
+
+    static constexpr double kHedgePercentile = 0.95;
+    static constexpr size_t kLatencyWindowSize = 128;
+    static constexpr size_t kMinLatencySamples = 20;
+
+    static constexpr size_t kFailureThreshold = 5;
+    static constexpr std::chrono::seconds kOpenTime{30};
+
+    struct Stats {
+        size_t retries = 0;
+        size_t hedges = 0;
+        size_t hedge_wins = 0;
+        size_t fast_failures = 0;
+    };
+
+ public:
+    YaRaspRequestGuard() = default;
+    // stops the hedge timer and waits for hedge attempts still running
+    ~YaRaspRequestGuard();
+
+    YaRaspRequestGuard(const YaRaspRequestGuard&) = delete;
+    YaRaspRequestGuard& operator=(const YaRaspRequestGuard&) = delete;
+
+ public:
+    // hedges need the executor, it must outlive the requests of the guard
+    void Configure(size_t max_attempts, bool hedging, YaRaspRequestExecutor* executor = nullptr);
+
+    // false while the circuit is open, the request is not sent;
+    // true once per kOpenTime for the probe of a half open circuit
+    bool Allow();
+    // the first attempt is admitted by the caller
+    cpr::Response Run(const AttemptFuncType& attempt, const AdmitFuncType& admit);
+
+ public:
+    bool IsOpen() const;
+    Stats GetStats() const;
+
+ private:
+    using ClockType = std::chrono::steady_clock;
+
+    // responses of both attempts of a hedged request, the first good one wins
+    struct Race;
+
+ private:
+    static bool IsRetryable(const cpr::Response& resp);
+
+    cpr::Response RunHedged(const AttemptFuncType& attempt, const AdmitFuncType& admit);
+    // submits the hedge of the race to an idle worker, when the first attempt still runs
+    std::function<void()> MakeHedgeLaunch(std::shared_ptr<Race> race, YaRaspRequestExecutor* executor,
+        AttemptFuncType attempt, AdmitFuncType admit);
+    void ScheduleHedge(ClockType::time_point hedge_time, std::function<void()> launch);
+    void HedgeTimerLoop();
+    std::chrono::milliseconds Backoff(size_t retry_index);
+    std::optional<std::chrono::milliseconds> HedgeDelay() const;
+    void Record(const cpr::Response& resp, ClockType::duration latency);
+
+ private:
+    mutable std::mutex mutex_;
+    std::condition_variable races_cv_;
+    std::condition_variable hedges_cv_;
+
+    size_t max_attempts_ = kDefaultMaxAttempts;
+    bool hedging_ = true;
+    YaRaspRequestExecutor* executor_ = nullptr;
+
+    std::deque<std::chrono::milliseconds> latencies_;
+    size_t failure_count_ = 0;
+    ClockType::time_point open_until_;
+    std::mt19937 random_{std::random_device{}()};
+    size_t running_attempt_count_ = 0;
+
+    // launches of hedges by their time
+    std::multimap<ClockType::time_point, std::function<void()>> pending_hedges_;
+    std::thread hedge_timer_;
+    bool is_stopping_ = false;
+
+    Stats stats_;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_REQUEST_GUARD_HPP_
@@ -0,0 +1,189 @@
+#include "ya_rasp_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+namespace waybuilder {
+
+namespace {
+
+const nlohmann::json::json_pointer kStateDay{"/day"};
+const nlohmann::json::json_pointer kStateUsed{"/used"};
+
+} // namespace
+
+
+void YaRaspRequestScheduler::Configure(size_t daily_limit, double rate, size_t burst) {
+    std::lock_guard lock{mutex_};
+
+    daily_limit_ = daily_limit;
+    rate_ = rate > 0 ? rate : kDefaultRate;
+    burst_ = std::max<double>(burst, 1);
+    tokens_ = std::min(tokens_, burst_);
+}
+
+
+bool YaRaspRequestScheduler::Load(const std::filesystem::path& state_path) {
+    std::lock_guard lock{mutex_};
+
+    state_path_ = state_path;
+
+    std::ifstream state_file{state_path_};
+
+    if (!state_file.is_open())
+        return false;
+
+    nlohmann::json state_json = nlohmann::json::parse(state_file, nullptr, false);
+
+    if (state_json.is_discarded() || !state_json.contains(kStateDay) || !state_json.at(kStateDay).is_number_integer()
+      || !state_json.contains(kStateUsed) || !state_json.at(kStateUsed).is_number_unsigned()) {
+        return false;
+    }
+
+    // counter of an earlier day is dropped on roll
+    day_ = state_json.at(kStateDay).get<int64_t>();
+    used_ = state_json.at(kStateUsed).get<size_t>();
+    RollDay();
+
+    return true;
+}
+
+
+bool YaRaspRequestScheduler::Acquire(RequestPriority priority) {
+    std::unique_lock lock{mutex_};
+
+    while (true) {
+        RollDay();
+
+        if (used_ + Reserve(priority) >= daily_limit_) {
+            ++refused_;
+            return false;
+        }
+
+        Refill();
+
+        const bool is_prefetch = priority == RequestPriority::PREFETCH;
+
+        // a prefetch takes a token only when no other request waits for one
+        if (tokens_ >= 1.0 && (!is_prefetch || waiting_count_ == 0)) {
+            tokens_ -= 1.0;
+            ++used_;
+            Dump();
+            return true;
+        }
+
+        const std::chrono::duration<double> wait_time{(tokens_ >= 1.0 ? 1.0 : 1.0 - tokens_) / rate_};
+
+        if (!is_prefetch) {
+            ++waiting_count_;
+        }
+
+        lock.unlock();
+        std::this_thread::sleep_for(wait_time);
+        lock.lock();
+
+        if (!is_prefetch) {
+            --waiting_count_;
+        }
+    }
+}
+
+
+size_t YaRaspRequestScheduler::GetDailyLimit() const {
+    std::lock_guard lock{mutex_};
+    return daily_limit_;
+}
+
+
+size_t YaRaspRequestScheduler::GetUsed() const {
+    std::lock_guard lock{mutex_};
+    return day_ == Today() ? used_ : 0;
+}
+
+
+size_t YaRaspRequestScheduler::GetRemaining() const {
+    std::lock_guard lock{mutex_};
+    const size_t used = day_ == Today() ? used_ : 0;
+    return used < daily_limit_ ? daily_limit_ - used : 0;
+}
+
+
+size_t YaRaspRequestScheduler::GetRefusedCount() const {
+    std::lock_guard lock{mutex_};
+    return refused_;
+}
+
+
+int64_t YaRaspRequestScheduler::Today() {
+    return std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now()).time_since_epoch().count();
+}
+
+
+void YaRaspRequestScheduler::RollDay() {
+    if (const int64_t today = Today(); today != day_) {
+        day_ = today;
+        used_ = 0;
+    }
+}
+
+
+void YaRaspRequestScheduler::Refill() {
+    const auto now = ClockType::now();
+    const std::chrono::duration<double> elapsed = now - refill_time_;
+
+    tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+    refill_time_ = now;
+}
+
+
+bool YaRaspRequestScheduler::Dump() const {
+    if (state_path_.empty())
+        return false;
+
+    nlohmann::json state_json;
+    state_json[kStateDay] = day_;
+    state_json[kStateUsed] = used_;
+
+    // written aside and renamed, a crash keeps the old counter, not an empty file
+    std::filesystem::path temp_path = state_path_;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream state_file{temp_path, std::ios::trunc};
+
+        if (!state_file.is_open())
+            return false;
+
+        state_file << state_json;
+
+        if (!state_file)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, state_path_, ec);
+    return !ec;
+}
+
+
+size_t YaRaspRequestScheduler::Reserve(RequestPriority priority) const {
+    switch (priority) {
+        case RequestPriority::PREFETCH:
+            return static_cast<size_t>(kPrefetchReserve * daily_limit_);
+        case RequestPriority::SCAN_POINTS:
+            return static_cast<size_t>(kScanPointsReserve * daily_limit_);
+        default:
+            return 0;
+    }
+}
+
+} // namespace waybuilder
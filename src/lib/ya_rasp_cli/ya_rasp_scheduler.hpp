@@ -0,0 +1,81 @@
+#ifndef _YA_RASP_SCHEDULER_HPP_
+#define _YA_RASP_SCHEDULER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+
+namespace waybuilder {
+
+enum class RequestPriority { INTERACTIVE, SCAN_POINTS, PREFETCH };
+
+
+// Admission of api requests against the daily request limit.
+// The counter of the current utc day is persisted in a small json file.
+// Each priority keeps a share of the limit for higher ones: prefetches stop
+// first, points scans next, interactive requests may spend the whole limit.
+// A token bucket paces requests, every request waits for a token. Prefetches
+// wait behind the interactive requests and points scans waiting for one.
+class YaRaspRequestScheduler {
+ public:
+    static constexpr size_t kDefaultDailyLimit = 500;
+    static constexpr double kDefaultRate = 5.0;
+    static constexpr size_t kDefaultBurst = 10;
+
+    static constexpr double kScanPointsReserve = 0.1;
+    static constexpr double kPrefetchReserve = 0.4;
+
+ public:
+    YaRaspRequestScheduler() = default;
+
+    YaRaspRequestScheduler(const YaRaspRequestScheduler&) = delete;
+    YaRaspRequestScheduler& operator=(const YaRaspRequestScheduler&) = delete;
+
+ public:
+    // rate in requests per second, burst is the bucket size
+    void Configure(size_t daily_limit, double rate, size_t burst);
+    bool Load(const std::filesystem::path& state_path);
+
+    // false if the request is refused by the daily limit,
+    // waits for a token and counts the request otherwise
+    bool Acquire(RequestPriority priority);
+
+ public:
+    size_t GetDailyLimit() const;
+    size_t GetUsed() const;
+    size_t GetRemaining() const;
+    size_t GetRefusedCount() const;
+
+ private:
+    using ClockType = std::chrono::steady_clock;
+
+ private:
+    static int64_t Today();
+
+    void RollDay();
+    void Refill();
+    bool Dump() const;
+    size_t Reserve(RequestPriority priority) const;
+
+ private:
+    mutable std::mutex mutex_;
+
+    std::filesystem::path state_path_;
+    int64_t day_ = Today();
+    size_t used_ = 0;
+    size_t refused_ = 0;
+
+    size_t daily_limit_ = kDefaultDailyLimit;
+    double rate_ = kDefaultRate;
+    double burst_ = kDefaultBurst;
+    double tokens_ = kDefaultBurst;
+    ClockType::time_point refill_time_ = ClockType::now();
+    // interactive requests and points scans waiting for a token
+    size_t waiting_count_ = 0;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_SCHEDULER_HPP_
@@ -0,0 +1,103 @@
+#include "ya_rasp_session_pool.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <cpr/cpr.h>
+
+namespace waybuilder {
+
+void YaRaspSessionPool::Configure(std::chrono::milliseconds timeout, std::chrono::milliseconds connect_timeout, bool verify_ssl) {
+    std::lock_guard lock{mutex_};
+
+    timeout_ = timeout;
+    connect_timeout_ = connect_timeout;
+    verify_ssl_ = verify_ssl;
+    idle_sessions_.clear();
+}
+
+
+void YaRaspSessionPool::SetMaxSize(size_t max_size) {
+    std::lock_guard lock{mutex_};
+
+    max_size_ = max_size;
+
+    if (idle_sessions_.size() > max_size_) {
+        idle_sessions_.resize(max_size_);
+    }
+}
+
+
+cpr::Response YaRaspSessionPool::Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout) {
+    std::unique_ptr<cpr::Session> session = Lease(timeout);
+
+    session->SetUrl(cpr::Url{url});
+    cpr::Response resp = session->Get();
+
+    // a failed transfer may leave the connection broken, the session is not reused
+    if (!resp.error) {
+        Return(std::move(session));
+    }
+
+    return resp;
+}
+
+
+cpr::Response YaRaspSessionPool::Download(const std::string& url, const cpr::WriteCallback& write,
+    std::optional<std::chrono::milliseconds> timeout) {
+    std::unique_ptr<cpr::Session> session = Lease(timeout);
+
+    session->SetUrl(cpr::Url{url});
+    return session->Download(write);
+}
+
+
+size_t YaRaspSessionPool::GetIdleCount() const {
+    std::lock_guard lock{mutex_};
+    return idle_sessions_.size();
+}
+
+
+size_t YaRaspSessionPool::GetCreatedCount() const {
+    std::lock_guard lock{mutex_};
+    return created_count_;
+}
+
+
+std::unique_ptr<cpr::Session> YaRaspSessionPool::Lease(std::optional<std::chrono::milliseconds> timeout) {
+    std::lock_guard lock{mutex_};
+
+    // an idle session may keep the timeout of its last request
+    if (!idle_sessions_.empty()) {
+        std::unique_ptr<cpr::Session> session = std::move(idle_sessions_.back());
+        idle_sessions_.pop_back();
+        session->SetTimeout(cpr::Timeout{timeout.value_or(timeout_)});
+        return session;
+    }
+
+    auto session = std::make_unique<cpr::Session>();
+    session->SetTimeout(cpr::Timeout{timeout.value_or(timeout_)});
+    session->SetConnectTimeout(cpr::ConnectTimeout{connect_timeout_});
+    session->SetHeader(cpr::Header{{"Connection", "keep-alive"}});
+    session->SetVerifySsl(cpr::VerifySsl{verify_ssl_});
+    session->SetAcceptEncoding(cpr::AcceptEncoding{{cpr::AcceptEncodingMethods::gzip}});
+
+    ++created_count_;
+    return session;
+}
+
+
+void YaRaspSessionPool::Return(std::unique_ptr<cpr::Session> session) {
+    std::lock_guard lock{mutex_};
+
+    if (idle_sessions_.size() < max_size_) {
+        idle_sessions_.push_back(std::move(session));
+    }
+}
+
+} // namespace waybuilder
@@ -0,0 +1,67 @@
+#ifndef _YA_RASP_SESSION_POOL_HPP_
+#define _YA_RASP_SESSION_POOL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+namespace waybuilder {
+
+// Reusable cpr sessions: a session keeps its connection and tls session to
+// the api host between requests, so only its first request pays dns, tcp and
+// tls handshakes. Each request leases an idle session or makes a new one,
+// at most max_size sessions are kept idle after use.
+// Sessions ask for gzip bodies, curl inflates them before they are handed out.
+class YaRaspSessionPool {
+ public:
+    static constexpr size_t kDefaultMaxSize = 4;
+    static constexpr std::chrono::milliseconds kDefaultTimeout{10000};
+    static constexpr std::chrono::milliseconds kDefaultConnectTimeout{3000};
+
+ public:
+    explicit YaRaspSessionPool(size_t max_size = kDefaultMaxSize) : max_size_{max_size} {  };
+
+    YaRaspSessionPool(const YaRaspSessionPool&) = delete;
+    YaRaspSessionPool& operator=(const YaRaspSessionPool&) = delete;
+
+ public:
+    // idle sessions with old settings are dropped,
+    // certificate checks are off only for local stand-ins of the api
+    void Configure(std::chrono::milliseconds timeout, std::chrono::milliseconds connect_timeout, bool verify_ssl = true);
+    void SetMaxSize(size_t max_size);
+
+    // timeout of this request, the configured one by default
+    cpr::Response Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout = {});
+    // body goes to the write callback instead of the response text,
+    // the callback stays set on the session, so it is not reused
+    cpr::Response Download(const std::string& url, const cpr::WriteCallback& write,
+        std::optional<std::chrono::milliseconds> timeout = {});
+
+ public:
+    size_t GetIdleCount() const;
+    size_t GetCreatedCount() const;
+
+ private:
+    std::unique_ptr<cpr::Session> Lease(std::optional<std::chrono::milliseconds> timeout);
+    void Return(std::unique_ptr<cpr::Session> session);
+
+ private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<cpr::Session>> idle_sessions_;
+    size_t max_size_;
+    size_t created_count_ = 0;
+
+    std::chrono::milliseconds timeout_ = kDefaultTimeout;
+    std::chrono::milliseconds connect_timeout_ = kDefaultConnectTimeout;
+    bool verify_ssl_ = true;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_SESSION_POOL_HPP_
@@ -0,0 +1,300 @@
+#include "ya_rasp_transport.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <cpr/cpr.h>
+
+namespace waybuilder {
+
+namespace {
+
+const nlohmann::json::json_pointer kRecordUrl{"/url"};
+const nlohmann::json::json_pointer kRecordStatusCode{"/status_code"};
+const nlohmann::json::json_pointer kRecordReason{"/reason"};
+const nlohmann::json::json_pointer kRecordElapsed{"/elapsed"};
+
+const std::string kMetaExtension = ".json";
+const std::string kBodyExtension = ".body";
+
+// fnv-1a, file names stay the same between builds
+uint64_t HashKey(std::string_view key) {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (unsigned char key_char : key) {
+        hash ^= key_char;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+} // namespace
+
+
+YaRaspLiveTransport::YaRaspLiveTransport(std::chrono::milliseconds timeout, std::chrono::milliseconds connect_timeout,
+    size_t max_idle_sessions, bool verify_ssl) : session_pool_{max_idle_sessions} {
+    session_pool_.Configure(timeout, connect_timeout, verify_ssl);
+}
+
+
+YaRaspCorpus::YaRaspCorpus(const std::filesystem::path& corpus_path) : corpus_path_{corpus_path} {
+    std::error_code ec;
+    std::filesystem::create_directories(corpus_path_, ec);
+}
+
+
+std::string YaRaspCorpus::MakeKey(std::string_view url) {
+    // scheme and host are dropped
+    if (size_t scheme_pos = url.find("://"); scheme_pos != std::string_view::npos) {
+        size_t path_pos = url.find('/', scheme_pos + 3);
+        url.remove_prefix(path_pos == std::string_view::npos ? url.size() : path_pos);
+    }
+
+    std::string key;
+    size_t query_pos = url.find('?');
+    key.append(url.substr(0, query_pos));
+
+    if (query_pos == std::string_view::npos) {
+        return key;
+    }
+
+    std::string_view query = url.substr(query_pos + 1);
+    char separator = '?';
+
+    while (!query.empty()) {
+        size_t arg_end = query.find('&');
+        std::string_view arg = query.substr(0, arg_end);
+        query.remove_prefix(arg_end == std::string_view::npos ? query.size() : arg_end + 1);
+
+        if (arg.empty() || arg.starts_with("apikey=")) {
+            continue;
+        }
+
+        key += separator;
+        key.append(arg);
+        separator = '&';
+    }
+
+    return key;
+}
+
+
+std::filesystem::path YaRaspCorpus::GetMetaPath(const std::string& key) const {
+    std::stringstream name_stream;
+    name_stream << std::hex << std::setw(16) << std::setfill('0') << HashKey(key) << kMetaExtension;
+    return corpus_path_ / name_stream.str();
+}
+
+
+std::filesystem::path YaRaspCorpus::GetBodyPath(const std::string& key) const {
+    return std::filesystem::path{GetMetaPath(key)}.replace_extension(kBodyExtension);
+}
+
+
+std::filesystem::path YaRaspCorpus::MakeTempPath(const std::string& key) {
+    return std::filesystem::path{GetMetaPath(key)}.replace_extension(".tmp" + std::to_string(temp_count_++));
+}
+
+
+bool YaRaspCorpus::Save(const std::string& key, const Record& record, const std::filesystem::path& temp_body_path) {
+    nlohmann::json meta_json;
+    meta_json[kRecordUrl] = key;
+    meta_json[kRecordStatusCode] = record.status_code;
+    meta_json[kRecordReason] = record.reason;
+    meta_json[kRecordElapsed] = record.elapsed;
+
+    const std::filesystem::path temp_meta_path = std::filesystem::path{temp_body_path}.concat(kMetaExtension);
+
+    {
+        std::ofstream meta_file{temp_meta_path, std::ios::trunc};
+
+        if (!meta_file.is_open() || !(meta_file << meta_json)) {
+            std::error_code ec;
+            std::filesystem::remove(temp_meta_path, ec);
+            std::filesystem::remove(temp_body_path, ec);
+            return false;
+        }
+    }
+
+    // body first, a meta file never points to a missing body
+    std::error_code ec;
+    std::filesystem::rename(temp_body_path, GetBodyPath(key), ec);
+
+    if (!ec) {
+        std::filesystem::rename(temp_meta_path, GetMetaPath(key), ec);
+    }
+
+    if (ec) {
+        std::filesystem::remove(temp_meta_path, ec);
+        std::filesystem::remove(temp_body_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+
+auto YaRaspCorpus::Load(const std::string& key) const -> std::optional<Record> {
+    std::ifstream meta_file{GetMetaPath(key)};
+
+    if (!meta_file.is_open())
+        return {};
+
+    nlohmann::json meta_json = nlohmann::json::parse(meta_file, nullptr, false);
+
+    // another key with the same hash is a miss
+    if (meta_json.is_discarded() || !meta_json.contains(kRecordUrl) || meta_json.at(kRecordUrl) != key
+      || !meta_json.contains(kRecordStatusCode) || !meta_json.at(kRecordStatusCode).is_number_integer()) {
+        return {};
+    }
+
+    Record record;
+    record.status_code = meta_json.at(kRecordStatusCode).get<long>();
+
+    if (meta_json.contains(kRecordReason) && meta_json.at(kRecordReason).is_string()) {
+        record.reason = meta_json.at(kRecordReason).get<std::string>();
+    }
+
+    if (meta_json.contains(kRecordElapsed) && meta_json.at(kRecordElapsed).is_number()) {
+        record.elapsed = meta_json.at(kRecordElapsed).get<double>();
+    }
+
+    return record;
+}
+
+
+cpr::Response YaRaspRecordTransport::Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout) {
+    cpr::Response resp = live_transport_->Get(url, timeout);
+
+    if (resp.error) {
+        return resp;
+    }
+
+    const std::string key = YaRaspCorpus::MakeKey(url);
+    const std::filesystem::path temp_body_path = corpus_.MakeTempPath(key);
+
+    std::ofstream body_file{temp_body_path, std::ios::binary | std::ios::trunc};
+    body_file << resp.text;
+    body_file.close();
+
+    if (body_file) {
+        corpus_.Save(key, YaRaspCorpus::Record{resp.status_code, resp.reason, resp.elapsed}, temp_body_path);
+    } else {
+        std::error_code ec;
+        std::filesystem::remove(temp_body_path, ec);
+    }
+
+    return resp;
+}
+
+
+cpr::Response YaRaspRecordTransport::Download(const std::string& url, const cpr::WriteCallback& write,
+    std::optional<std::chrono::milliseconds> timeout) {
+    const std::string key = YaRaspCorpus::MakeKey(url);
+    const std::filesystem::path temp_body_path = corpus_.MakeTempPath(key);
+
+    // the body is written to the corpus as it passes to the caller
+    std::ofstream body_file{temp_body_path, std::ios::binary | std::ios::trunc};
+
+    cpr::Response resp = live_transport_->Download(url,
+        cpr::WriteCallback{[&body_file, &write](std::string_view data, intptr_t) {
+            body_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            return write.callback(data, write.userdata);
+        }},
+        timeout
+    );
+
+    body_file.close();
+
+    if (!resp.error && body_file) {
+        corpus_.Save(key, YaRaspCorpus::Record{resp.status_code, resp.reason, resp.elapsed}, temp_body_path);
+    } else {
+        std::error_code ec;
+        std::filesystem::remove(temp_body_path, ec);
+    }
+
+    return resp;
+}
+
+
+cpr::Response YaRaspReplayTransport::Get(const std::string& url, std::optional<std::chrono::milliseconds>) {
+    const std::string key = YaRaspCorpus::MakeKey(url);
+    const auto record = corpus_.Load(key);
+
+    cpr::Response resp = Replay(url, key, record);
+
+    if (record) {
+        std::ifstream body_file{corpus_.GetBodyPath(key), std::ios::binary};
+        resp.text.assign(std::istreambuf_iterator<char>{body_file}, std::istreambuf_iterator<char>{});
+    }
+
+    return resp;
+}
+
+
+cpr::Response YaRaspReplayTransport::Download(const std::string& url, const cpr::WriteCallback& write,
+    std::optional<std::chrono::milliseconds>) {
+    const std::string key = YaRaspCorpus::MakeKey(url);
+    const auto record = corpus_.Load(key);
+
+    cpr::Response resp = Replay(url, key, record);
+
+    if (!record) {
+        return resp;
+    }
+
+    std::ifstream body_file{corpus_.GetBodyPath(key), std::ios::binary};
+    std::vector<char> chunk(kChunkSize);
+
+    while (body_file.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || body_file.gcount() > 0) {
+        if (!write.callback(std::string_view{chunk.data(), static_cast<size_t>(body_file.gcount())}, write.userdata)) {
+            // as curl does when the callback refuses a chunk
+            resp.error = cpr::Error{};
+            resp.error.code = cpr::ErrorCode::UNKNOWN_ERROR;
+            resp.error.message = "write callback refused the body";
+            break;
+        }
+    }
+
+    return resp;
+}
+
+
+cpr::Response YaRaspReplayTransport::Replay(const std::string& url, const std::string& key,
+    const std::optional<YaRaspCorpus::Record>& record) const {
+    cpr::Response resp;
+    resp.url = cpr::Url{url};
+
+    if (!record) {
+        resp.status_code = 0;
+        resp.reason = "request is not in the replay corpus: " + key;
+        return resp;
+    }
+
+    if (replay_latency_ && record->elapsed > 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>{record->elapsed});
+    }
+
+    resp.status_code = record->status_code;
+    resp.reason = record->reason;
+    resp.elapsed = record->elapsed;
+
+    return resp;
+}
+
+} // namespace waybuilder
@@ -0,0 +1,135 @@
+#ifndef _YA_RASP_TRANSPORT_HPP_
+#define _YA_RASP_TRANSPORT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <cpr/cpr.h>
+
+#include "ya_rasp_session_pool.hpp"
+
+namespace waybuilder {
+
+// Way api requests leave YaRaspCli through a transport, so sessions can be
+// recorded once and replayed offline. Implementations are thread safe,
+// requests run on request threads concurrently.
+class YaRaspTransport {
+ public:
+    virtual ~YaRaspTransport() = default;
+
+ public:
+    // timeout of this request, the transport default if empty
+    virtual cpr::Response Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout = {}) = 0;
+    // body goes to the write callback instead of the response text
+    virtual cpr::Response Download(const std::string& url, const cpr::WriteCallback& write,
+        std::optional<std::chrono::milliseconds> timeout = {}) = 0;
+};
+
+
+// Requests to the network through pooled cpr sessions.
+class YaRaspLiveTransport : public YaRaspTransport {
+ public:
+    YaRaspLiveTransport(std::chrono::milliseconds timeout, std::chrono::milliseconds connect_timeout,
+        size_t max_idle_sessions, bool verify_ssl = true);
+
+ public:
+    cpr::Response Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout = {}) override {
+        return session_pool_.Get(url, timeout);
+    };
+    cpr::Response Download(const std::string& url, const cpr::WriteCallback& write,
+        std::optional<std::chrono::milliseconds> timeout = {}) override {
+        return session_pool_.Download(url, write, timeout);
+    };
+
+ public:
+    YaRaspSessionPool& GetSessionPoolRef() { return session_pool_; };
+
+ private:
+    YaRaspSessionPool session_pool_;
+};
+
+
+// On-disk corpus of responses: a record is a json meta file with status,
+// reason and latency, and a raw body file. Records are keyed by the request
+// path and query without the api host and the api key, so the key never
+// reaches the disk and a corpus replays against any api url. A newer record
+// of a request replaces the older one.
+class YaRaspCorpus {
+ public:
+    struct Record {
+        long status_code = 0;
+        std::string reason;
+        double elapsed = 0;
+    };
+
+ public:
+    explicit YaRaspCorpus(const std::filesystem::path& corpus_path);
+
+ public:
+    static std::string MakeKey(std::string_view url);
+
+    std::filesystem::path GetMetaPath(const std::string& key) const;
+    std::filesystem::path GetBodyPath(const std::string& key) const;
+    // unique path of a record being written, renamed into place once complete
+    std::filesystem::path MakeTempPath(const std::string& key);
+
+    bool Save(const std::string& key, const Record& record, const std::filesystem::path& temp_body_path);
+    std::optional<Record> Load(const std::string& key) const;
+
+ private:
+    std::filesystem::path corpus_path_;
+    std::atomic<size_t> temp_count_ = 0;
+};
+
+
+// Live requests, each response is also saved to the corpus.
+// Failed transfers are not recorded.
+class YaRaspRecordTransport : public YaRaspTransport {
+ public:
+    YaRaspRecordTransport(std::unique_ptr<YaRaspTransport> live_transport, const std::filesystem::path& corpus_path)
+        : live_transport_{std::move(live_transport)}, corpus_{corpus_path} {  };
+
+ public:
+    cpr::Response Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout = {}) override;
+    cpr::Response Download(const std::string& url, const cpr::WriteCallback& write,
+        std::optional<std::chrono::milliseconds> timeout = {}) override;
+
+ private:
+    std::unique_ptr<YaRaspTransport> live_transport_;
+    YaRaspCorpus corpus_;
+};
+
+
+// Responses served from the corpus without the network, optionally after
+// the recorded latency. Requests missing in the corpus get status code 0.
+class YaRaspReplayTransport : public YaRaspTransport {
+ public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+ public:
+    YaRaspReplayTransport(const std::filesystem::path& corpus_path, bool replay_latency)
+        : corpus_{corpus_path}, replay_latency_{replay_latency} {  };
+
+ public:
+    cpr::Response Get(const std::string& url, std::optional<std::chrono::milliseconds> timeout = {}) override;
+    cpr::Response Download(const std::string& url, const cpr::WriteCallback& write,
+        std::optional<std::chrono::milliseconds> timeout = {}) override;
+
+ private:
+    // meta of the recorded response, status code 0 if there is none
+    cpr::Response Replay(const std::string& url, const std::string& key, const std::optional<YaRaspCorpus::Record>& record) const;
+
+ private:
+    YaRaspCorpus corpus_;
+    bool replay_latency_;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_TRANSPORT_HPP_
@@ -0,0 +1,93 @@
+#include "ya_rasp_trigram_index.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace waybuilder {
+
+void YaRaspTrigramIndex::Build(uint32_t point_count, const TitleFuncType& title) {
+    Clear();
+    point_count_ = point_count;
+
+    for (uint32_t point = 0; point < point_count; ++point) {
+        const std::string_view point_title = title(point);
+
+        for (size_t pos = 0; pos + kGramSize <= point_title.size(); ++pos) {
+            std::vector<uint32_t>& points = postings_[Gram(point_title, pos)];
+
+            // points come in order, a gram repeated in one title is kept once
+            if (points.empty() || points.back() != point) {
+                points.push_back(point);
+            }
+        }
+    }
+}
+
+
+void YaRaspTrigramIndex::Clear() {
+    postings_.clear();
+    point_count_ = 0;
+}
+
+
+std::vector<uint32_t> YaRaspTrigramIndex::Search(std::string_view part, const TitleFuncType& title) const {
+    std::vector<uint32_t> result;
+
+    if (part.size() < kGramSize) {
+        for (uint32_t point = 0; point < point_count_; ++point) {
+            if (title(point).find(part) != std::string_view::npos) {
+                result.push_back(point);
+            }
+        }
+        return result;
+    }
+
+    std::vector<const std::vector<uint32_t>*> gram_points;
+
+    for (size_t pos = 0; pos + kGramSize <= part.size(); ++pos) {
+        auto postings_it = postings_.find(Gram(part, pos));
+
+        if (postings_it == postings_.end()) {
+            return result;
+        }
+
+        gram_points.push_back(&postings_it->second);
+    }
+
+    std::sort(gram_points.begin(), gram_points.end(),
+        [](const auto* lhs, const auto* rhs) { return lhs->size() < rhs->size(); });
+    gram_points.erase(std::unique(gram_points.begin(), gram_points.end()), gram_points.end());
+
+    std::vector<uint32_t> candidates = *gram_points.front();
+    std::vector<uint32_t> intersection;
+
+    for (size_t index = 1; index < gram_points.size() && !candidates.empty(); ++index) {
+        intersection.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), gram_points[index]->begin(), gram_points[index]->end(),
+            std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+
+    // all grams present do not make a substring, the order of grams is checked
+    for (uint32_t point : candidates) {
+        if (title(point).find(part) != std::string_view::npos) {
+            result.push_back(point);
+        }
+    }
+
+    return result;
+}
+
+
+uint32_t YaRaspTrigramIndex::Gram(std::string_view text, size_t pos) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16
+        | static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8
+        | static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+} // namespace waybuilder
@@ -0,0 +1,44 @@
+#ifndef _YA_RASP_TRIGRAM_INDEX_HPP_
+#define _YA_RASP_TRIGRAM_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace waybuilder {
+
+// Inverted index of byte trigrams of point titles: every trigram keeps the
+// sorted list of points whose title has it. A substring query intersects the
+// lists of its trigrams, shortest first, and checks the few candidates left
+// against the titles. Queries shorter than a trigram scan all titles.
+class YaRaspTrigramIndex {
+ public:
+    static constexpr size_t kGramSize = 3;
+
+    // title of a point, points are numbered from zero
+    using TitleFuncType = std::function<std::string_view(uint32_t)>;
+
+ public:
+    YaRaspTrigramIndex() = default;
+
+ public:
+    void Build(uint32_t point_count, const TitleFuncType& title);
+    void Clear();
+
+    // points whose title has the part, in ascending order
+    std::vector<uint32_t> Search(std::string_view part, const TitleFuncType& title) const;
+
+ private:
+    static uint32_t Gram(std::string_view text, size_t pos);
+
+ private:
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_;
+    uint32_t point_count_ = 0;
+};
+
+} // namespace waybuilder
+
+#endif // _YA_RASP_TRIGRAM_INDEX_HPP_
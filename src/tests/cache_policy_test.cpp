@@ -0,0 +1,149 @@
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include <lru_cache.hpp>
+#include <cache_policy.hpp>
+
+namespace {
+
+constexpr size_t kCacheSize = 4;
+
+template<typename PolicyType>
+using CacheType = waybuilder::__detail::LruCache<int, int, kCacheSize, waybuilder::__detail::UnitWeigher<int>, PolicyType>;
+
+using LruCacheType = CacheType<waybuilder::__detail::LruPolicy<int>>;
+using WTinyLfuCacheType = CacheType<waybuilder::__detail::WTinyLfuPolicy<int>>;
+using ArcCacheType = CacheType<waybuilder::__detail::ArcPolicy<int>>;
+
+template<typename CacheT>
+void Fill(CacheT& cache) {
+    for (int key = 0; key < static_cast<int>(kCacheSize); ++key) {
+        ASSERT_TRUE(cache.insert(key, key));
+    }
+}
+
+
+TEST(LruPolicyTest, EvictsLeastRecentlyUsed) {
+    LruCacheType cache;
+    Fill(cache);
+
+    // 0 is used again, 1 is the least recent now
+    ASSERT_TRUE(cache.get(0));
+    ASSERT_TRUE(cache.insert(10, 10));
+
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(10));
+
+    ASSERT_TRUE(cache.insert(11, 11));
+    EXPECT_FALSE(cache.contains(2));
+
+    EXPECT_EQ(cache.size(), kCacheSize);
+    EXPECT_EQ(cache.stats().evictions, 2u);
+}
+
+
+// keys 0-2 get several hits and leave the window, key 3 is the cold window entry
+void FillHot(WTinyLfuCacheType& cache) {
+    Fill(cache);
+
+    for (int round = 0; round < 3; ++round) {
+        for (int key = 0; key < static_cast<int>(kCacheSize) - 1; ++key) {
+            ASSERT_TRUE(cache.get(key));
+        }
+    }
+}
+
+
+TEST(WTinyLfuPolicyTest, NewKeyWaitsInWindow) {
+    WTinyLfuCacheType cache;
+    FillHot(cache);
+
+    // the new key is kept, the cold entry it pushes out of the window loses to the victim
+    ASSERT_TRUE(cache.insert(10, 10));
+    EXPECT_TRUE(cache.contains(10));
+    EXPECT_FALSE(cache.contains(3));
+
+    // unused in the window, the key competes once the next key comes and loses
+    ASSERT_TRUE(cache.insert(11, 11));
+    EXPECT_FALSE(cache.contains(10));
+    EXPECT_TRUE(cache.contains(11));
+
+    for (int key = 0; key < static_cast<int>(kCacheSize) - 1; ++key) {
+        EXPECT_TRUE(cache.contains(key)) << key;
+    }
+    EXPECT_EQ(cache.stats().evictions, 2u);
+}
+
+
+TEST(WTinyLfuPolicyTest, AdmitsWindowKeyHotterThanVictim) {
+    WTinyLfuCacheType cache;
+    FillHot(cache);
+
+    ASSERT_TRUE(cache.insert(10, 10));
+
+    // hits in the window make the key hotter than any resident
+    for (int lookup = 0; lookup < 5; ++lookup) {
+        ASSERT_TRUE(cache.get(10));
+    }
+
+    ASSERT_TRUE(cache.insert(11, 11));
+    EXPECT_TRUE(cache.contains(10));
+    EXPECT_TRUE(cache.contains(11));
+    EXPECT_EQ(cache.size(), kCacheSize);
+    EXPECT_EQ(cache.stats().evictions, 2u);
+}
+
+
+TEST(WTinyLfuPolicyTest, EvictsProbationBeforeProtected) {
+    WTinyLfuCacheType cache;
+    Fill(cache);
+
+    // a hit on probation protects the entry, the rest stay on probation
+    ASSERT_TRUE(cache.get(1));
+    ASSERT_TRUE(cache.get(1));
+
+    // the window entry is hot, so the victim leaves
+    for (int lookup = 0; lookup < 5; ++lookup) {
+        ASSERT_TRUE(cache.get(3));
+    }
+
+    ASSERT_TRUE(cache.insert(10, 10));
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_FALSE(cache.contains(0));
+}
+
+
+TEST(ArcPolicyTest, EvictsRecentBeforeFrequent) {
+    ArcCacheType cache;
+    Fill(cache);
+
+    // 0 moves to the frequent list, 1 is the oldest recent entry
+    ASSERT_TRUE(cache.get(0));
+    ASSERT_TRUE(cache.insert(10, 10));
+
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(10));
+}
+
+
+TEST(ArcPolicyTest, GhostHitReturnsAsFrequent) {
+    ArcCacheType cache;
+    Fill(cache);
+
+    ASSERT_TRUE(cache.insert(10, 10));
+    ASSERT_FALSE(cache.contains(0));
+
+    // 0 was evicted from the recent list, coming back it is frequent,
+    // so the next victim is a recent entry
+    ASSERT_TRUE(cache.insert(0, 0));
+    ASSERT_TRUE(cache.insert(11, 11));
+
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_EQ(cache.size(), kCacheSize);
+}
+
+} // namespace
@@ -0,0 +1,36 @@
+#ifndef _TEST_TEMP_DIR_HPP_
+#define _TEST_TEMP_DIR_HPP_
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace waybuilder::test {
+
+// a fresh directory under the system temp directory, removed with its files
+class TestTempDir {
+ public:
+    explicit TestTempDir(const std::string& prefix)
+      : path_{std::filesystem::temp_directory_path() / (prefix + std::to_string(std::random_device{}()))} {
+        std::filesystem::create_directories(path_);
+    };
+
+    ~TestTempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    };
+
+    TestTempDir(const TestTempDir&) = delete;
+    TestTempDir& operator=(const TestTempDir&) = delete;
+
+ public:
+    const std::filesystem::path& Path() const { return path_; };
+
+ private:
+    std::filesystem::path path_;
+};
+
+} // namespace waybuilder::test
+
+#endif // _TEST_TEMP_DIR_HPP_
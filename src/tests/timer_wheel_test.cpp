@@ -0,0 +1,94 @@
+#include <ctime>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <timer_wheel.hpp>
+
+namespace {
+
+constexpr std::time_t kStartTime = 1'000'000;
+
+using TimerWheelType = waybuilder::__detail::TimerWheel<int>;
+using ExpiredType = std::vector<std::pair<int, std::time_t>>;
+
+ExpiredType AdvanceTo(TimerWheelType& timer_wheel, std::time_t current_time) {
+    ExpiredType expired;
+    timer_wheel.Advance(current_time, [&expired](int key, std::time_t expire_time) { expired.emplace_back(key, expire_time); });
+    return expired;
+}
+
+
+TEST(TimerWheelTest, ExpiresOnTime) {
+    TimerWheelType timer_wheel{kStartTime};
+    timer_wheel.Schedule(1, kStartTime + 5);
+
+    EXPECT_TRUE(AdvanceTo(timer_wheel, kStartTime + 4).empty());
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 5), (ExpiredType{{1, kStartTime + 5}}));
+    EXPECT_TRUE(timer_wheel.empty());
+}
+
+
+TEST(TimerWheelTest, CascadesUpperLevels) {
+    TimerWheelType timer_wheel{kStartTime};
+
+    // one timer on each level of the wheel
+    timer_wheel.Schedule(1, kStartTime + 10);
+    timer_wheel.Schedule(2, kStartTime + 100);
+    timer_wheel.Schedule(3, kStartTime + 5'000);
+    timer_wheel.Schedule(4, kStartTime + 300'000);
+    ASSERT_EQ(timer_wheel.size(), 4u);
+
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 99), (ExpiredType{{1, kStartTime + 10}}));
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 100), (ExpiredType{{2, kStartTime + 100}}));
+    EXPECT_TRUE(AdvanceTo(timer_wheel, kStartTime + 4'999).empty());
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 5'000), (ExpiredType{{3, kStartTime + 5'000}}));
+    EXPECT_TRUE(AdvanceTo(timer_wheel, kStartTime + 299'999).empty());
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 300'000), (ExpiredType{{4, kStartTime + 300'000}}));
+    EXPECT_TRUE(timer_wheel.empty());
+}
+
+
+TEST(TimerWheelTest, ExpiresInOrderWithinOneAdvance) {
+    TimerWheelType timer_wheel{kStartTime};
+
+    timer_wheel.Schedule(3, kStartTime + 3'000);
+    timer_wheel.Schedule(1, kStartTime + 1);
+    timer_wheel.Schedule(2, kStartTime + 70);
+
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime + 10'000),
+        (ExpiredType{{1, kStartTime + 1}, {2, kStartTime + 70}, {3, kStartTime + 3'000}}));
+}
+
+
+TEST(TimerWheelTest, PastTimerExpiresOnNextAdvance) {
+    TimerWheelType timer_wheel{kStartTime};
+    timer_wheel.Schedule(1, kStartTime - 10);
+
+    EXPECT_EQ(AdvanceTo(timer_wheel, kStartTime), (ExpiredType{{1, kStartTime - 10}}));
+}
+
+
+TEST(TimerWheelTest, TimerBeyondRangeIsParked) {
+    TimerWheelType timer_wheel{kStartTime};
+
+    // further than 64^4 seconds, placed again on each cascade
+    const std::time_t far_time = kStartTime + 20'000'000;
+    timer_wheel.Schedule(1, far_time);
+
+    EXPECT_TRUE(AdvanceTo(timer_wheel, far_time - 1).empty());
+    EXPECT_EQ(AdvanceTo(timer_wheel, far_time), (ExpiredType{{1, far_time}}));
+}
+
+
+TEST(TimerWheelTest, ClearDropsTimers) {
+    TimerWheelType timer_wheel{kStartTime};
+    timer_wheel.Schedule(1, kStartTime + 1);
+    timer_wheel.clear();
+
+    EXPECT_TRUE(timer_wheel.empty());
+    EXPECT_TRUE(AdvanceTo(timer_wheel, kStartTime + 10).empty());
+}
+
+} // namespace
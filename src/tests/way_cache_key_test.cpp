@@ -0,0 +1,119 @@
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <way_cache_key.hpp>
+
+namespace {
+
+using waybuilder::WayCacheKey;
+using waybuilder::WayCacheKeyFactory;
+
+
+TEST(WayCacheKeyTest, DayRoundTrip) {
+    WayCacheKeyFactory factory;
+
+    for (const std::string date : {"1970-01-01", "2000-02-29", "2024-12-31", "2026-10-16"}) {
+        auto key = factory.MakeKey("c213", "c2", date, "ru_RU");
+
+        ASSERT_TRUE(key) << date;
+        EXPECT_EQ(factory.ToString(*key), "c213|c2|" + date + "|ru_RU|0");
+    }
+
+    EXPECT_EQ(factory.MakeKey("c213", "c2", "1970-01-02", "ru_RU")->day, 1);
+    EXPECT_EQ(factory.MakeKey("c213", "c2", "1969-12-31", "ru_RU")->day, -1);
+}
+
+
+TEST(WayCacheKeyTest, EmptyDateIsAnyDay) {
+    WayCacheKeyFactory factory;
+    auto key = factory.MakeKey("c213", "c2", "", "ru_RU");
+
+    ASSERT_TRUE(key);
+    EXPECT_EQ(key->day, WayCacheKey::kAnyDay);
+}
+
+
+TEST(WayCacheKeyTest, MalformedDateIsRejected) {
+    WayCacheKeyFactory factory;
+
+    for (const std::string date : {"2024-2-01", "2024/02/01", "2024-02-30", "2023-02-29", "2024-13-01", "2024-00-10",
+        "20a4-01-01", "2024-01-01 ", "today"}) {
+        EXPECT_FALSE(factory.MakeKey("c213", "c2", date, "ru_RU")) << date;
+    }
+}
+
+
+TEST(WayCacheKeyTest, KeyFields) {
+    WayCacheKeyFactory factory;
+    auto key = factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true, "train,plane");
+
+    ASSERT_TRUE(key);
+    EXPECT_EQ(factory.GetCode(key->from_point), "c213");
+    EXPECT_EQ(factory.GetCode(key->to_point), "c2");
+    EXPECT_EQ(factory.GetCode(key->lang), "ru_RU");
+    // days since epoch
+    EXPECT_EQ(key->day, 19844);
+    EXPECT_EQ(key->flags, WayCacheKey::kTransfersFlag | 0b11u);
+}
+
+
+TEST(WayCacheKeyTest, UnknownTransportIsRejected) {
+    WayCacheKeyFactory factory;
+
+    EXPECT_FALSE(factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", false, "train,rocket"));
+    EXPECT_FALSE(factory.MakeKey("c213", "c2", "2024-05-32", "ru_RU"));
+}
+
+
+TEST(WayCacheKeyTest, EqualQueriesMakeEqualKeys) {
+    WayCacheKeyFactory factory;
+
+    auto key = factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true, "plane,train");
+    auto same_key = factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true, "train,plane");
+    auto back_key = factory.MakeKey("c2", "c213", "2024-05-01", "ru_RU", true, "plane,train");
+
+    ASSERT_TRUE(key && same_key && back_key);
+    EXPECT_EQ(*key, *same_key);
+    EXPECT_EQ(std::hash<WayCacheKey>{}(*key), std::hash<WayCacheKey>{}(*same_key));
+    EXPECT_NE(*key, *back_key);
+}
+
+
+TEST(WayCacheKeyTest, ToStringIsCanonical) {
+    WayCacheKeyFactory factory;
+    WayCacheKeyFactory other_factory;
+
+    // interned ids differ between factories, the text does not
+    other_factory.MakeKey("s9600213", "c54", "", "en_US");
+
+    auto key = factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true);
+    auto other_key = other_factory.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true);
+
+    ASSERT_TRUE(key && other_key);
+    EXPECT_EQ(factory.ToString(*key), "c213|c2|2024-05-01|ru_RU|80000000");
+    EXPECT_EQ(factory.ToString(*key), other_factory.ToString(*other_key));
+
+    auto undated_key = factory.MakeKey("c213", "c2", "", "ru_RU");
+    ASSERT_TRUE(undated_key);
+    EXPECT_EQ(factory.ToString(*undated_key), "c213|c2||ru_RU|0");
+}
+
+
+TEST(WayCacheKeyTest, DaysMaskKeyIsApart) {
+    WayCacheKeyFactory factory;
+    auto pair_key = factory.MakeKey("c213", "c2", "", "ru_RU", true);
+
+    ASSERT_TRUE(pair_key);
+
+    const WayCacheKey days_mask_key = WayCacheKeyFactory::MakeDaysMaskKey(*pair_key);
+
+    EXPECT_NE(days_mask_key, *pair_key);
+    EXPECT_NE(days_mask_key.hash, pair_key->hash);
+    EXPECT_EQ(days_mask_key.flags, pair_key->flags | WayCacheKey::kDaysMaskFlag);
+    EXPECT_EQ(WayCacheKeyFactory::MakeDaysMaskKey(*pair_key), days_mask_key);
+}
+
+} // namespace
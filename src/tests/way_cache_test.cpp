@@ -0,0 +1,113 @@
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <lru_cache.hpp>
+#include <way_cache.hpp>
+#include <way_cache_weigher.hpp>
+
+#include "test_temp_dir.hpp"
+
+namespace {
+
+constexpr std::time_t kLifetime = 60 * 60;
+constexpr size_t kMemCacheSize = 16;
+
+using MemCacheType = waybuilder::__detail::LruCache<waybuilder::WayCacheKey, std::pair<nlohmann::json, std::time_t>, kMemCacheSize>;
+using CacheType = waybuilder::__detail::WayCache<MemCacheType>;
+
+// memory budget in bytes, a few small values fit
+constexpr size_t kMemCacheBudget = 4096;
+
+using WeighedMemCacheType = waybuilder::__detail::LruCache<waybuilder::WayCacheKey, std::pair<nlohmann::json, std::time_t>,
+    kMemCacheBudget, waybuilder::WayCacheWeigher>;
+using WeighedCacheType = waybuilder::__detail::WayCache<WeighedMemCacheType>;
+
+class WayCacheTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        cache_.emplace(cache_dir_.Path().string(), kLifetime, 0, 0);
+    };
+
+    waybuilder::WayCacheKey MakeKey(const std::string& to_point) {
+        return *cache_->MakeKey("c213", to_point, "2024-05-01", "ru_RU", true);
+    };
+
+ protected:
+    waybuilder::test::TestTempDir cache_dir_{"way_cache_test_"};
+    std::optional<CacheType> cache_;
+};
+
+
+TEST_F(WayCacheTest, DefinitiveClientErrorsAreCached) {
+    for (long status_code : {400, 404}) {
+        const auto key = MakeKey(std::to_string(status_code));
+
+        EXPECT_TRUE(CacheType::IsCacheableClientError(status_code));
+        EXPECT_TRUE(cache_->InsertNegative(key, CacheType::MissReason::CLIENT_ERROR, status_code));
+
+        auto negative_entry = cache_->GetNegative(key);
+        ASSERT_TRUE(negative_entry);
+        EXPECT_EQ(negative_entry->reason, CacheType::MissReason::CLIENT_ERROR);
+        EXPECT_EQ(negative_entry->status_code, status_code);
+    }
+}
+
+
+TEST_F(WayCacheTest, TransientClientErrorsAreNotCached) {
+    for (long status_code : {401, 403, 408, 429}) {
+        const auto key = MakeKey(std::to_string(status_code));
+
+        EXPECT_FALSE(CacheType::IsCacheableClientError(status_code));
+        EXPECT_FALSE(cache_->InsertNegative(key, CacheType::MissReason::CLIENT_ERROR, status_code));
+        EXPECT_FALSE(cache_->GetNegative(key));
+    }
+}
+
+
+TEST_F(WayCacheTest, NoWaysIsCached) {
+    const auto key = MakeKey("c2");
+
+    EXPECT_TRUE(cache_->InsertNegative(key, CacheType::MissReason::NO_WAYS));
+
+    auto negative_entry = cache_->GetNegative(key);
+    ASSERT_TRUE(negative_entry);
+    EXPECT_EQ(negative_entry->reason, CacheType::MissReason::NO_WAYS);
+}
+
+
+TEST_F(WayCacheTest, FoundWaysClearNegativeEntry) {
+    const auto key = MakeKey("c2");
+
+    ASSERT_TRUE(cache_->InsertNegative(key, CacheType::MissReason::NO_WAYS));
+    ASSERT_TRUE(cache_->insert(key, {nlohmann::json{{"segments", nlohmann::json::array()}}, std::time(nullptr)}));
+
+    EXPECT_FALSE(cache_->GetNegative(key));
+    EXPECT_TRUE(cache_->get(key));
+}
+
+
+TEST_F(WayCacheTest, ValueOverMemoryBudgetIsServedFromDisk) {
+    cache_.reset();
+    WeighedCacheType cache{cache_dir_.Path().string(), kLifetime, 0, 0};
+
+    const auto key = *cache.MakeKey("c213", "c2", "2024-05-01", "ru_RU", true);
+    const std::pair<nlohmann::json, std::time_t> value{std::string(2 * kMemCacheBudget, 'w'), std::time(nullptr)};
+
+    ASSERT_GT(waybuilder::WayCacheWeigher{}(value), cache.capacity());
+    EXPECT_TRUE(cache.insert(key, value));
+    EXPECT_FALSE(cache.contains(key));
+
+    auto cached_value = cache.get(key);
+    ASSERT_TRUE(cached_value);
+    EXPECT_EQ(cached_value->first, value.first);
+}
+
+} // namespace
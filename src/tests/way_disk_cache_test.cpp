@@ -0,0 +1,127 @@
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <way_disk_cache.hpp>
+
+#include "test_temp_dir.hpp"
+
+namespace {
+
+constexpr std::time_t kLifetime = 60 * 60;
+
+class WayDiskCacheTest : public testing::Test {
+ protected:
+    std::filesystem::path JournalPath() const { return cache_dir_.Path() / "ways.journal"; };
+
+    void AppendLine(const std::string& line) {
+        std::ofstream journal_file{JournalPath(), std::ios::binary | std::ios::app};
+        journal_file << line;
+    };
+
+    static std::string Record(const std::string& key, std::time_t stamp, int value) {
+        return nlohmann::json{{"key", key}, {"stamp", stamp}, {"value", value}}.dump() + '\n';
+    };
+
+ protected:
+    waybuilder::test::TestTempDir cache_dir_{"way_disk_cache_test_"};
+    std::time_t now_ = std::time(nullptr);
+};
+
+
+TEST_F(WayDiskCacheTest, RecordsSurviveReopen) {
+    {
+        waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+        ASSERT_TRUE(cache.Insert("a", {nlohmann::json{{"ways", 1}}, now_}));
+        ASSERT_TRUE(cache.Insert("b", {2, now_}));
+        cache.Erase("b");
+    }
+
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    EXPECT_EQ(cache.Size(), 1u);
+    ASSERT_TRUE(cache.Get("a"));
+    EXPECT_EQ(cache.Get("a")->first, (nlohmann::json{{"ways", 1}}));
+    EXPECT_EQ(cache.Get("a")->second, now_);
+    EXPECT_FALSE(cache.Get("b"));
+}
+
+
+TEST_F(WayDiskCacheTest, LaterRecordReplacesEarlier) {
+    AppendLine(Record("a", now_, 1));
+    AppendLine(Record("a", now_, 2));
+
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    EXPECT_EQ(cache.Size(), 1u);
+    EXPECT_EQ(cache.Get("a")->first, 2);
+}
+
+
+TEST_F(WayDiskCacheTest, TornTailIsCut) {
+    AppendLine(Record("a", now_, 1));
+    const auto whole_size = std::filesystem::file_size(JournalPath());
+    AppendLine(R"({"key":"b","sta)");
+
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    EXPECT_EQ(cache.Size(), 1u);
+    EXPECT_TRUE(cache.Get("a"));
+    EXPECT_FALSE(cache.Get("b"));
+    EXPECT_EQ(std::filesystem::file_size(JournalPath()), whole_size);
+}
+
+
+TEST_F(WayDiskCacheTest, CorruptRecordIsSkipped) {
+    AppendLine(Record("a", now_, 1));
+    AppendLine("{not json\n");
+    AppendLine(R"({"key":"s","stamp":"yesterday","value":1})" "\n");
+    AppendLine(Record("b", now_, 2));
+
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_EQ(cache.Get("a")->first, 1);
+    EXPECT_EQ(cache.Get("b")->first, 2);
+    EXPECT_FALSE(cache.Get("s"));
+
+    // records after the corrupt ones are kept and new ones follow them
+    ASSERT_TRUE(cache.Insert("c", {3, now_}));
+    waybuilder::WayDiskCache reopened_cache{cache_dir_.Path().string(), kLifetime};
+    EXPECT_EQ(reopened_cache.Size(), 3u);
+}
+
+
+TEST_F(WayDiskCacheTest, ExpiredRecordIsDropped) {
+    AppendLine(Record("old", now_ - 2 * kLifetime, 1));
+
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    EXPECT_FALSE(cache.GetStamp("old"));
+    EXPECT_FALSE(cache.Get("old"));
+}
+
+
+TEST_F(WayDiskCacheTest, CompactKeepsLiveRecords) {
+    waybuilder::WayDiskCache cache{cache_dir_.Path().string(), kLifetime};
+
+    for (int value = 0; value < 10; ++value) {
+        ASSERT_TRUE(cache.Insert("a", {value, now_}));
+    }
+    ASSERT_TRUE(cache.Insert("b", {1, now_}));
+    cache.Erase("b");
+
+    ASSERT_TRUE(cache.Compact());
+
+    waybuilder::WayDiskCache reopened_cache{cache_dir_.Path().string(), kLifetime};
+    EXPECT_EQ(reopened_cache.Size(), 1u);
+    EXPECT_EQ(reopened_cache.Get("a")->first, 9);
+    EXPECT_FALSE(std::filesystem::exists(cache_dir_.Path() / "ways.journal.tmp"));
+}
+
+} // namespace
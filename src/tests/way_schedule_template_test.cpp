@@ -0,0 +1,87 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <way_cache_key.hpp>
+#include <way_schedule_template.hpp>
+
+namespace {
+
+using waybuilder::WayCacheKeyFactory;
+using waybuilder::WayScheduleTemplate;
+
+// a thread running every other day from 2024-05-01
+nlohmann::json MakeSegment(const std::string& uid) {
+    return {
+        {"thread", {{"uid", uid}}},
+        {"departure", "08:30:00"},
+        {"arrival", "12:45:00"},
+        {"duration", 4 * 60 * 60 + 15 * 60},
+        {"start_date", "2024-05-01"},
+        {"days_mask", "1010101"}
+    };
+}
+
+
+nlohmann::json MakeWays(size_t segment_count, size_t total) {
+    nlohmann::json ways_json{
+        {"search", {{"from", {{"code", "c213"}}}, {"to", {{"code", "c2"}}}}},
+        {"segments", nlohmann::json::array()},
+        {"interval_segments", nlohmann::json::array()},
+        {"pagination", {{"total", total}, {"limit", segment_count}, {"offset", 0}}}
+    };
+
+    for (size_t segment = 0; segment < segment_count; ++segment) {
+        ways_json["segments"].push_back(MakeSegment(std::to_string(segment)));
+    }
+
+    return ways_json;
+}
+
+
+int32_t Day(const std::string& date) {
+    return *WayCacheKeyFactory::ParseDay(date);
+}
+
+
+TEST(WayScheduleTemplateTest, RendersRunningDays) {
+    WayScheduleTemplate schedule_template{MakeWays(2, 2)};
+
+    ASSERT_TRUE(schedule_template.IsValid());
+    EXPECT_EQ(schedule_template.Size(), 2u);
+    EXPECT_TRUE(schedule_template.Covers(Day("2024-05-07")));
+    EXPECT_FALSE(schedule_template.Covers(Day("2024-05-08")));
+
+    nlohmann::json ways_json = schedule_template.Render(Day("2024-05-03"));
+    ASSERT_EQ(ways_json["segments"].size(), 2u);
+    EXPECT_EQ(ways_json["segments"][0]["departure"], "2024-05-03T08:30:00");
+    EXPECT_EQ(ways_json["segments"][0]["arrival"], "2024-05-03T12:45:00");
+    EXPECT_FALSE(ways_json["segments"][0].contains("days_mask"));
+    EXPECT_EQ(ways_json["search"]["date"], "2024-05-03");
+    EXPECT_EQ(ways_json["pagination"]["total"], 2);
+
+    EXPECT_TRUE(schedule_template.Render(Day("2024-05-02"))["segments"].empty());
+}
+
+
+TEST(WayScheduleTemplateTest, TruncatedPageIsInvalid) {
+    WayScheduleTemplate schedule_template{MakeWays(2, 3)};
+
+    EXPECT_FALSE(schedule_template.IsValid());
+    EXPECT_FALSE(schedule_template.Covers(Day("2024-05-03")));
+    EXPECT_TRUE(schedule_template.Render(Day("2024-05-03")).is_null());
+}
+
+
+TEST(WayScheduleTemplateTest, ThreadWithoutMaskIsInvalid) {
+    nlohmann::json ways_json = MakeWays(2, 2);
+    ways_json["segments"][1].erase("days_mask");
+
+    EXPECT_FALSE(WayScheduleTemplate{ways_json}.IsValid());
+}
+
+} // namespace
@@ -0,0 +1,258 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ya_rasp_point_index.hpp>
+
+#include "test_temp_dir.hpp"
+
+namespace {
+
+using waybuilder::PointLevel;
+using waybuilder::YaRaspPointIndex;
+
+// header: magic, version, four level sizes, pool size
+constexpr size_t kHeaderSize = 7 * sizeof(uint32_t);
+
+nlohmann::json MakePoint(const std::string& code, const std::string& title) {
+    return {{"codes", {{"yandex_code", code}}}, {"title", title}};
+}
+
+
+// one country, one region, one city with two stations
+nlohmann::json MakePointList() {
+    nlohmann::json city = MakePoint("c213", "Moscow");
+    city["stations"] = {MakePoint("s2000001", "Kursky"), MakePoint("s2000006", "Belorussky")};
+
+    nlohmann::json region = MakePoint("", "Moscow and Moscow Oblast");
+    region["settlements"] = {city};
+
+    nlohmann::json country = MakePoint("l225", "Russia");
+    country["regions"] = {region};
+
+    return {{"countries", {country}}};
+}
+
+
+std::optional<std::string> BuildIndex(const std::string& point_list) {
+    std::istringstream point_list_stream{point_list};
+    return YaRaspPointIndex::Build(point_list_stream);
+}
+
+
+uint32_t ReadValue(const std::string& index_data, size_t value_index) {
+    uint32_t value = 0;
+    std::memcpy(&value, index_data.data() + kHeaderSize + value_index * sizeof(uint32_t), sizeof(value));
+    return value;
+}
+
+
+void WriteValue(std::string& index_data, size_t value_index, uint32_t value) {
+    std::memcpy(index_data.data() + kHeaderSize + value_index * sizeof(uint32_t), &value, sizeof(value));
+}
+
+
+// value indexes of the arrays of a level for level sizes {1, 1, 1, 2}
+struct LevelLayout {
+    size_t code_offsets;
+    size_t title_offsets;
+    size_t parents;
+    size_t child_offsets;
+};
+
+LevelLayout GetLayout(size_t level) {
+    const std::vector<size_t> sizes = {1, 1, 1, 2};
+
+    size_t value_index = 0;
+    for (size_t prev_level = 0; prev_level < level; ++prev_level) {
+        value_index += 4 * sizes[prev_level] + 3;
+    }
+
+    const size_t size = sizes[level];
+    return {value_index, value_index + size + 1, value_index + 2 * size + 2, value_index + 3 * size + 2};
+}
+
+
+class YaRaspPointIndexTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        auto index_data = BuildIndex(MakePointList().dump());
+        ASSERT_TRUE(index_data);
+        index_data_ = std::move(*index_data);
+    };
+
+    std::filesystem::path IndexPath() const { return index_dir_.Path() / ("points" + YaRaspPointIndex::kIndexExtension); };
+
+ protected:
+    waybuilder::test::TestTempDir index_dir_{"point_index_test_"};
+    std::string index_data_;
+};
+
+
+TEST_F(YaRaspPointIndexTest, RoundTrip) {
+    ASSERT_TRUE(YaRaspPointIndex::Save(index_data_, IndexPath()));
+
+    YaRaspPointIndex index;
+    ASSERT_TRUE(index.Open(IndexPath()));
+
+    EXPECT_EQ(index.Size(PointLevel::COUNTRY), 1u);
+    EXPECT_EQ(index.Size(PointLevel::REGION), 1u);
+    EXPECT_EQ(index.Size(PointLevel::CITY), 1u);
+    EXPECT_EQ(index.Size(PointLevel::STATION), 2u);
+
+    EXPECT_EQ(index.GetCode(PointLevel::COUNTRY, 0), "l225");
+    EXPECT_EQ(index.GetTitle(PointLevel::REGION, 0), "Moscow and Moscow Oblast");
+    EXPECT_EQ(index.GetCode(PointLevel::REGION, 0), "");
+    EXPECT_EQ(index.GetTitle(PointLevel::STATION, 1), "Belorussky");
+
+    EXPECT_EQ(index.GetParent(PointLevel::COUNTRY, 0), YaRaspPointIndex::kNoParent);
+    EXPECT_EQ(index.GetParent(PointLevel::STATION, 1), 0u);
+    EXPECT_EQ(index.GetChildren(PointLevel::CITY, 0), (YaRaspPointIndex::RangeType{0, 2}));
+    EXPECT_EQ(index.GetChildren(PointLevel::STATION, 0), (YaRaspPointIndex::RangeType{0, 0}));
+}
+
+
+TEST_F(YaRaspPointIndexTest, FindsPoints) {
+    YaRaspPointIndex index;
+    ASSERT_TRUE(index.Assign(index_data_));
+
+    auto point_ref = index.Find("s2000006");
+    ASSERT_TRUE(point_ref);
+    EXPECT_EQ(point_ref->level, PointLevel::STATION);
+    EXPECT_EQ(point_ref->point, 1u);
+    EXPECT_FALSE(index.Find("s1"));
+    EXPECT_FALSE(index.Find(""));
+
+    EXPECT_EQ(index.FindCode(PointLevel::CITY, index.All(PointLevel::CITY), "c213"), 0u);
+    EXPECT_FALSE(index.FindCode(PointLevel::CITY, index.All(PointLevel::CITY), "s2000001"));
+
+    EXPECT_EQ(index.FindTitle(PointLevel::STATION, "russ"), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(index.FindTitle(PointLevel::STATION, "y"), (std::vector<uint32_t>{0, 1}));
+    EXPECT_TRUE(index.FindTitle(PointLevel::STATION, "Moscow").empty());
+}
+
+
+TEST_F(YaRaspPointIndexTest, KeyOrderIsIgnored) {
+    // children before the fields of their point, lookalike keys out of place
+    const std::string point_list = R"({"stations": [{"title": "Lost"}], "countries": [{
+        "regions": [{
+            "settlements": [{"stations": [{"title": "Kursky", "codes": {"yandex_code": "s2000001"}}],
+                "codes": {"esr_code": "1", "yandex_code": "c213"}, "title": "Moscow"}],
+            "title": "Moscow and Moscow Oblast", "codes": {}
+        }],
+        "title": "Russia", "codes": {"yandex_code": "l225", "stations": [{"title": "Lost"}]}
+    }]})";
+
+    auto index_data = BuildIndex(point_list);
+    ASSERT_TRUE(index_data);
+
+    YaRaspPointIndex index;
+    ASSERT_TRUE(index.Assign(std::move(*index_data)));
+
+    EXPECT_EQ(index.Size(PointLevel::COUNTRY), 1u);
+    EXPECT_EQ(index.Size(PointLevel::STATION), 1u);
+    EXPECT_EQ(index.GetCode(PointLevel::COUNTRY, 0), "l225");
+    EXPECT_EQ(index.GetTitle(PointLevel::CITY, 0), "Moscow");
+    EXPECT_EQ(index.GetCode(PointLevel::CITY, 0), "c213");
+    EXPECT_EQ(index.GetView(PointLevel::STATION, 0).code, "s2000001");
+    EXPECT_EQ(index.GetParent(PointLevel::STATION, 0), 0u);
+    EXPECT_EQ(index.GetChildren(PointLevel::REGION, 0), (YaRaspPointIndex::RangeType{0, 1}));
+}
+
+
+TEST_F(YaRaspPointIndexTest, MalformedListIsRejected) {
+    EXPECT_FALSE(BuildIndex(R"({"countries": [{"title": "Russia"})"));
+    EXPECT_FALSE(BuildIndex(""));
+    EXPECT_TRUE(BuildIndex(R"({"countries": "none"})"));
+}
+
+
+TEST_F(YaRaspPointIndexTest, MissingFileIsRejected) {
+    YaRaspPointIndex index;
+
+    EXPECT_FALSE(index.Open(IndexPath()));
+    EXPECT_FALSE(index.IsOpen());
+}
+
+
+TEST_F(YaRaspPointIndexTest, ForeignFileIsRejected) {
+    std::ofstream{IndexPath(), std::ios::binary} << R"({"countries": []})";
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Open(IndexPath()));
+}
+
+
+TEST_F(YaRaspPointIndexTest, BadMagicIsRejected) {
+    index_data_[0] = 'X';
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+
+TEST_F(YaRaspPointIndexTest, TruncatedFileIsRejected) {
+    index_data_.pop_back();
+    ASSERT_TRUE(YaRaspPointIndex::Save(index_data_, IndexPath()));
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Open(IndexPath()));
+}
+
+
+TEST_F(YaRaspPointIndexTest, DecreasingOffsetIsRejected) {
+    const LevelLayout layout = GetLayout(3);
+    WriteValue(index_data_, layout.code_offsets + 1, ReadValue(index_data_, layout.code_offsets) - 1);
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+
+TEST_F(YaRaspPointIndexTest, OffsetPastPoolIsRejected) {
+    const LevelLayout layout = GetLayout(1);
+    WriteValue(index_data_, layout.title_offsets, UINT32_MAX);
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+
+TEST_F(YaRaspPointIndexTest, ChildrenPastLevelAreRejected) {
+    const LevelLayout layout = GetLayout(2);
+    WriteValue(index_data_, layout.child_offsets + 1, 3);
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+
+TEST_F(YaRaspPointIndexTest, ParentOutOfRangeIsRejected) {
+    const LevelLayout layout = GetLayout(3);
+    WriteValue(index_data_, layout.parents + 1, 1);
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+
+TEST_F(YaRaspPointIndexTest, CountryWithParentIsRejected) {
+    const LevelLayout layout = GetLayout(0);
+    WriteValue(index_data_, layout.parents, 0);
+
+    YaRaspPointIndex index;
+    EXPECT_FALSE(index.Assign(index_data_));
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ya_rasp_scheduler.hpp>
+
+#include "test_temp_dir.hpp"
+
+namespace {
+
+using waybuilder::RequestPriority;
+using waybuilder::YaRaspRequestScheduler;
+
+constexpr size_t kDailyLimit = 100;
+// fast enough that token waits stay short
+constexpr double kRate = 1000.0;
+constexpr size_t kBurst = 2;
+
+int64_t Today() {
+    return std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now()).time_since_epoch().count();
+}
+
+
+class YaRaspSchedulerTest : public testing::Test {
+ protected:
+    std::filesystem::path StatePath() const { return state_dir_.Path() / "quota.json"; };
+
+    void WriteState(const std::string& state) {
+        std::ofstream{StatePath()} << state;
+    };
+
+ protected:
+    waybuilder::test::TestTempDir state_dir_{"scheduler_test_"};
+};
+
+
+TEST_F(YaRaspSchedulerTest, UsedCountSurvivesRestart) {
+    {
+        YaRaspRequestScheduler scheduler;
+        scheduler.Configure(kDailyLimit, kRate, kBurst);
+        EXPECT_FALSE(scheduler.Load(StatePath()));
+
+        for (size_t request = 0; request < 5; ++request) {
+            ASSERT_TRUE(scheduler.Acquire(RequestPriority::INTERACTIVE));
+        }
+    }
+
+    YaRaspRequestScheduler scheduler;
+    scheduler.Configure(kDailyLimit, kRate, kBurst);
+
+    ASSERT_TRUE(scheduler.Load(StatePath()));
+    EXPECT_EQ(scheduler.GetUsed(), 5u);
+    EXPECT_EQ(scheduler.GetRemaining(), kDailyLimit - 5);
+    EXPECT_FALSE(std::filesystem::exists(StatePath().string() + ".tmp"));
+}
+
+
+TEST_F(YaRaspSchedulerTest, EarlierDayIsDropped) {
+    WriteState(nlohmann::json{{"day", Today() - 1}, {"used", 50}}.dump());
+
+    YaRaspRequestScheduler scheduler;
+    scheduler.Configure(kDailyLimit, kRate, kBurst);
+
+    ASSERT_TRUE(scheduler.Load(StatePath()));
+    EXPECT_EQ(scheduler.GetUsed(), 0u);
+}
+
+
+TEST_F(YaRaspSchedulerTest, MalformedStateIsIgnored) {
+    for (const std::string state : {"", "{", R"({"day": "today", "used": 1})", R"({"day": 1, "used": -1})"}) {
+        WriteState(state);
+
+        YaRaspRequestScheduler scheduler;
+        EXPECT_FALSE(scheduler.Load(StatePath())) << state;
+        EXPECT_EQ(scheduler.GetUsed(), 0u) << state;
+    }
+}
+
+
+TEST_F(YaRaspSchedulerTest, LimitHoldsAcrossRestart) {
+    WriteState(nlohmann::json{{"day", Today()}, {"used", kDailyLimit - 1}}.dump());
+
+    YaRaspRequestScheduler scheduler;
+    scheduler.Configure(kDailyLimit, kRate, kBurst);
+    ASSERT_TRUE(scheduler.Load(StatePath()));
+
+    // prefetches keep a reserve for interactive requests, those spend the rest
+    EXPECT_FALSE(scheduler.Acquire(RequestPriority::PREFETCH));
+    EXPECT_TRUE(scheduler.Acquire(RequestPriority::INTERACTIVE));
+    EXPECT_FALSE(scheduler.Acquire(RequestPriority::INTERACTIVE));
+    EXPECT_EQ(scheduler.GetRefusedCount(), 2u);
+
+    YaRaspRequestScheduler restarted_scheduler;
+    restarted_scheduler.Configure(kDailyLimit, kRate, kBurst);
+    ASSERT_TRUE(restarted_scheduler.Load(StatePath()));
+    EXPECT_EQ(restarted_scheduler.GetRemaining(), 0u);
+}
+
+
+TEST_F(YaRaspSchedulerTest, PrefetchWaitsForToken) {
+    YaRaspRequestScheduler scheduler;
+    scheduler.Configure(kDailyLimit, kRate, kBurst);
+    scheduler.Load(StatePath());
+
+    // more prefetches than the bucket holds, none is refused
+    for (size_t request = 0; request < 4 * kBurst; ++request) {
+        EXPECT_TRUE(scheduler.Acquire(RequestPriority::PREFETCH));
+    }
+
+    EXPECT_EQ(scheduler.GetRefusedCount(), 0u);
+    EXPECT_EQ(scheduler.GetUsed(), 4 * kBurst);
+}
+
+} // namespace